@@ -309,3 +309,229 @@ printBits (char c[35], float f)
 
     c[34] = 0;
 }
+
+
+//---------------------------------------------------------------------------
+// Batch conversion
+//
+// The SIMD float-to-half path only handles values that become normalized
+// halfs, and zeroes; it uses the same integer rounding as the inline
+// half (float) constructor, so the results are identical.  Groups that
+// contain any other value (denormals, overflows, infinities, NANs) go
+// through half (float) one value at a time.
+//
+// The F16C half-to-float instruction is exact for all halfs except
+// signaling NANs, which it quiets.  Groups with NANs use the table.
+//---------------------------------------------------------------------------
+
+#if defined (_M_X64) || defined (__x86_64__) || defined (_M_IX86) || defined (__i386__)
+    #define HALF_HAVE_X86 1
+#endif
+
+#ifdef HALF_HAVE_X86
+
+#if defined (_MSC_VER)
+    #include <intrin.h>
+    #define HALF_TARGET_AVX2
+    #define HALF_TARGET_F16C
+#else
+    #include <cpuid.h>
+    #define HALF_TARGET_AVX2 __attribute__ ((target ("avx2")))
+    #define HALF_TARGET_F16C __attribute__ ((target ("avx,f16c")))
+#endif
+
+#include <immintrin.h>
+
+namespace {
+
+struct CpuFeatures
+{
+    bool avx2;
+    bool f16c;
+};
+
+
+CpuFeatures
+detectCpuFeatures ()
+{
+    CpuFeatures features = {false, false};
+    unsigned int regs[4] = {0, 0, 0, 0};
+
+    #if defined (_MSC_VER)
+	__cpuid ((int *) regs, 0);
+	unsigned int maxLeaf = regs[0];
+	__cpuid ((int *) regs, 1);
+    #else
+	unsigned int maxLeaf = __get_cpuid_max (0, 0);
+	__cpuid (1, regs[0], regs[1], regs[2], regs[3]);
+    #endif
+
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    bool f16c = (regs[2] & (1 << 29)) != 0;
+
+    //
+    // The OS must save the YMM registers for AVX code to be usable
+    //
+
+    if (!osxsave || !avx)
+	return features;
+
+    #if defined (_MSC_VER)
+	unsigned long long xcr0 = _xgetbv (0);
+    #else
+	unsigned int eax, edx;
+	__asm__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+	unsigned long long xcr0 = ((unsigned long long) edx << 32) | eax;
+    #endif
+
+    if ((xcr0 & 6) != 6)
+	return features;
+
+    features.f16c = f16c;
+
+    if (maxLeaf >= 7)
+    {
+	#if defined (_MSC_VER)
+	    __cpuidex ((int *) regs, 7, 0);
+	#else
+	    __cpuid_count (7, 0, regs[0], regs[1], regs[2], regs[3]);
+	#endif
+
+	features.avx2 = (regs[1] & (1 << 5)) != 0;
+    }
+
+    return features;
+}
+
+
+const CpuFeatures &
+cpuFeatures ()
+{
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+
+//
+// Convert 8 floats to halfs.  Returns false, without storing
+// anything, if one of the floats needs the slow path.
+//
+
+HALF_TARGET_AVX2
+bool
+floatToHalf8 (const float *src, unsigned short *dst)
+{
+    __m256i i = _mm256_loadu_si256 ((const __m256i *) src);
+    __m256i a = _mm256_and_si256 (i, _mm256_set1_epi32 (0x7fffffff));
+
+    __m256i normal = _mm256_and_si256
+	(_mm256_cmpgt_epi32 (a, _mm256_set1_epi32 (0x387fffff)),
+	 _mm256_cmpgt_epi32 (_mm256_set1_epi32 (0x47800000), a));
+
+    __m256i zero = _mm256_cmpeq_epi32 (a, _mm256_setzero_si256());
+
+    if (_mm256_movemask_epi8 (_mm256_or_si256 (normal, zero)) != -1)
+	return false;
+
+    //
+    // Rebias the exponent, round the significand and merge
+    // in the sign, like the inline half (float) constructor.
+    //
+
+    __m256i h = _mm256_srli_epi32
+	(_mm256_add_epi32 (a, _mm256_set1_epi32 (0x00001000 - 0x38000000)), 13);
+
+    h = _mm256_or_si256 (h, _mm256_and_si256 (_mm256_srli_epi32 (i, 16),
+					      _mm256_set1_epi32 (0x8000)));
+
+    h = _mm256_and_si256 (h, normal);
+
+    //
+    // Sign extend so the saturating pack keeps all 16 bits
+    //
+
+    h = _mm256_srai_epi32 (_mm256_slli_epi32 (h, 16), 16);
+
+    __m128i packed = _mm_packs_epi32 (_mm256_castsi256_si128 (h),
+				      _mm256_extracti128_si256 (h, 1));
+
+    _mm_storeu_si128 ((__m128i *) dst, packed);
+    return true;
+}
+
+
+//
+// Convert 8 halfs to floats.  Returns false, without storing
+// anything, if one of the halfs is a NAN.
+//
+
+HALF_TARGET_F16C
+bool
+halfToFloat8 (const unsigned short *src, float *dst)
+{
+    __m128i h = _mm_loadu_si128 ((const __m128i *) src);
+    __m128i e = _mm_and_si128 (h, _mm_set1_epi16 (0x7fff));
+
+    if (_mm_movemask_epi8 (_mm_cmpgt_epi16 (e, _mm_set1_epi16 (0x7c00))))
+	return false;
+
+    _mm256_storeu_ps (dst, _mm256_cvtph_ps (h));
+    return true;
+}
+
+} // namespace
+
+#endif // HALF_HAVE_X86
+
+
+void
+floatToHalfArray (const float src[], half dst[], size_t n)
+{
+    size_t i = 0;
+
+    #ifdef HALF_HAVE_X86
+
+	if (cpuFeatures().avx2)
+	{
+	    for (; i + 8 <= n; i += 8)
+	    {
+		if (!floatToHalf8 (src + i, (unsigned short *) (dst + i)))
+		{
+		    for (size_t j = i; j < i + 8; ++j)
+			dst[j] = half (src[j]);
+		}
+	    }
+	}
+
+    #endif
+
+    for (; i < n; ++i)
+	dst[i] = half (src[i]);
+}
+
+
+void
+halfToFloatArray (const half src[], float dst[], size_t n)
+{
+    size_t i = 0;
+
+    #ifdef HALF_HAVE_X86
+
+	if (cpuFeatures().f16c)
+	{
+	    for (; i + 8 <= n; i += 8)
+	    {
+		if (!halfToFloat8 ((const unsigned short *) (src + i), dst + i))
+		{
+		    for (size_t j = i; j < i + 8; ++j)
+			dst[j] = float (src[j]);
+		}
+	    }
+	}
+
+    #endif
+
+    for (; i < n; ++i)
+	dst[i] = float (src[i]);
+}
@@ -86,6 +86,7 @@
 #define _HALF_H_
 
 #include <iostream>
+#include <stddef.h>
 
 class half
 {
@@ -257,6 +258,22 @@ void			printBits   (char  c[19], half  h);
 void			printBits   (char  c[35], float f);
 
 
+//-------------------------------------------------------------------------
+// Batch conversion
+//
+//	floatToHalfArray (src, dst, n) converts n floats to halfs,
+//	halfToFloatArray (src, dst, n) converts n halfs to floats.
+//
+//	The results are bit for bit the same as converting one value at
+//	a time with half (float) and float (half).  Where the CPU supports
+//	them, AVX2 and F16C instructions convert several values at once,
+//	otherwise the lookup tables are used.
+//-------------------------------------------------------------------------
+
+void			floatToHalfArray (const float src[], half dst[], size_t n);
+void			halfToFloatArray (const half src[], float dst[], size_t n);
+
+
 //-------------------------------------------------------------------------
 // Limits
 //
@@ -78,6 +78,22 @@ struct HufDec
 };
 
 
+//
+// Multi-symbol decoding table entry: the literals of up to three
+// consecutive short codes that fit in HUF_DECBITS bits, and their
+// total length.  Entries with n < 2 are not used.
+//
+
+const int HUF_MULTISYMS = 3;
+
+struct HufMultiDec
+{
+    unsigned short	lit[HUF_MULTISYMS];
+    unsigned char	n;		// number of literals
+    unsigned char	len;		// total code length
+};
+
+
 void
 invalidNBits ()
 {
@@ -681,6 +697,46 @@ hufBuildDecTable
 }
 
 
+//
+// Build a multi-symbol decoding table from a table built by
+// hufBuildDecTable().  For every HUF_DECBITS-bit window, chain the
+// short codes that start at the top of the window as long as they
+// fit.  The run-length code is never chained, it must be followed
+// by its 8-bit run count.
+//
+
+void
+hufBuildMultiDecTable
+    (const HufDec *	hdecod,		// i : decoding table
+     int		rlc,		// i : run-length code
+     HufMultiDec *	hmulti)		//  o: (allocated by caller)
+     					//     decoding table [HUF_DECSIZE]
+{
+    for (int i = 0; i < HUF_DECSIZE; i++)
+    {
+	HufMultiDec &m = hmulti[i];
+	m.n = 0;
+	m.len = 0;
+
+	int window = i;
+	int bits = HUF_DECBITS;
+
+	while (m.n < HUF_MULTISYMS)
+	{
+	    const HufDec &pl = hdecod[window];
+
+	    if (pl.len == 0 || pl.len > bits || pl.lit == rlc)
+		break;
+
+	    m.lit[m.n++] = pl.lit;
+	    m.len += pl.len;
+	    bits -= pl.len;
+	    window = (window << pl.len) & HUF_DECMASK;
+	}
+    }
+}
+
+
 //
 // Free the long code entries of a decoding table built by hufBuildDecTable()
 //
@@ -839,6 +895,7 @@ void
 hufDecode
     (const Int64 * 	hcode,	// i : encoding table
      const HufDec * 	hdecod,	// i : decoding table
+     const HufMultiDec*	hmulti,	// i : multi-symbol decoding table, or 0
      const char* 	in,	// i : compressed input buffer
      int		ni,	// i : input size (in bits)
      int		rlc,	// i : run-length code
@@ -859,13 +916,38 @@ hufDecode
     {
 	getChar (c, lc, in);
 
+	//
+	// Keep a few bytes buffered, so that the multi-symbol
+	// table gets a full window more often
+	//
+
+	while (lc < 40 && in < ie)
+	    getChar (c, lc, in);
+
 	//
 	// Access decoding table
 	//
 
 	while (lc >= HUF_DECBITS)
 	{
-	    const HufDec pl = hdecod[(c >> (lc-HUF_DECBITS)) & HUF_DECMASK];
+	    int w = (c >> (lc-HUF_DECBITS)) & HUF_DECMASK;
+
+	    if (hmulti && hmulti[w].n > 1 && out + hmulti[w].n <= oe)
+	    {
+		//
+		// Several short codes at once
+		//
+
+		const HufMultiDec &pm = hmulti[w];
+
+		for (int k = 0; k < pm.n; ++k)
+		    *out++ = pm.lit[k];
+
+		lc -= pm.len;
+		continue;
+	    }
+
+	    const HufDec pl = hdecod[w];
 
 	    if (pl.len)
 	    {
@@ -1057,7 +1139,22 @@ hufUncompress (const char compressed[],
 	    invalidNBits();
 
 	hufBuildDecTable (freq, im, iM, hdec);
-	hufDecode (freq, hdec, ptr, nBits, iM, nRaw, raw);
+
+	//
+	// Building the multi-symbol table costs about as much as
+	// decoding HUF_DECSIZE symbols; only do it for larger blocks.
+	//
+
+	if (nRaw >= 4 * HUF_DECSIZE)
+	{
+	    AutoArray <HufMultiDec, HUF_DECSIZE> hmulti;
+	    hufBuildMultiDecTable (hdec, iM, hmulti);
+	    hufDecode (freq, hdec, hmulti, ptr, nBits, iM, nRaw, raw);
+	}
+	else
+	{
+	    hufDecode (freq, hdec, 0, ptr, nBits, iM, nRaw, raw);
+	}
     }
     catch (...)
     {
@@ -573,6 +573,21 @@ InputFile::readPixels (int scanLine)
 }
 
 
+void
+InputFile::readAllPixels ()
+{
+    if (isTiled (_data->version))
+    {
+	const Box2i &dataWindow = _data->header.dataWindow();
+	readPixels (dataWindow.min.y, dataWindow.max.y);
+    }
+    else
+    {
+        _data->sFile->readAllPixels ();
+    }
+}
+
+
 void
 InputFile::rawPixelData (int firstScanLine,
 			 const char *&pixelData,
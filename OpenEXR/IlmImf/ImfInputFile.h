@@ -167,6 +167,21 @@ class InputFile
     void		readPixels (int scanLine);
 
 
+    //---------------------------------------------------------------
+    // Read all pixel data:
+    //
+    // readAllPixels() reads every scan line of the data window, like
+    // readPixels (dataWindow.min.y, dataWindow.max.y), but reads the
+    // raw data of a scan line file in a few large sequential blocks
+    // instead of one line buffer at a time, see class
+    // Imf::ScanLineInputFile.
+    //
+    // Tiled files are read with readPixels().
+    //---------------------------------------------------------------
+
+    void		readAllPixels ();
+
+
     //----------------------------------------------
     // Read a block of raw pixel data from the file,
     // without uncompressing it (this function is
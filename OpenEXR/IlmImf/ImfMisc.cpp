@@ -484,6 +484,21 @@ copyIntoFrameBuffer (const char *& readPtr,
 
               case HALF:
 
+                if (xStride == sizeof (float) && writePtr <= endPtr)
+                {
+                    //
+                    // Contiguous destination, convert the whole
+                    // row at once.
+                    //
+
+                    size_t n = (endPtr - writePtr) / xStride + 1;
+                    halfToFloatArray ((const half *) readPtr,
+                                      (float *) writePtr, n);
+                    readPtr += n * sizeof (half);
+                    writePtr += n * xStride;
+                    break;
+                }
+
                 while (writePtr <= endPtr)
                 {
                     half h = *(half *) readPtr;
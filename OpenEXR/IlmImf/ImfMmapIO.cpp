@@ -0,0 +1,233 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2005, Industrial Light & Magic, a division of Lucas
+// Digital Ltd. LLC
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// *       Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// *       Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+// *       Neither the name of Industrial Light & Magic nor the names of
+// its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+//-----------------------------------------------------------------------------
+//
+//	Low-level file input for OpenEXR based on memory-mapped files.
+//
+//-----------------------------------------------------------------------------
+
+#include <ImfMmapIO.h>
+#include "Iex.h"
+#include <string.h>
+
+#if defined _WIN32 || defined _WIN64
+    #include <windows.h>
+#else
+    #include <sys/types.h>
+    #include <sys/stat.h>
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <errno.h>
+#endif
+
+namespace Imf {
+
+
+#if defined _WIN32 || defined _WIN64
+
+MmapIStream::MmapIStream (const char fileName[]):
+    IStream (fileName),
+    _base (0),
+    _size (0),
+    _pos (0),
+    _file (INVALID_HANDLE_VALUE),
+    _mapping (0)
+{
+    _file = CreateFileA (fileName, GENERIC_READ, FILE_SHARE_READ, 0,
+			 OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, 0);
+
+    if (_file == INVALID_HANDLE_VALUE)
+	THROW (Iex::InputExc, "Cannot open file \"" << fileName << "\".");
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx (_file, &size))
+    {
+	CloseHandle (_file);
+	THROW (Iex::InputExc, "Cannot get size of file \"" <<
+			      fileName << "\".");
+    }
+
+    _size = size.QuadPart;
+
+    //
+    // Empty files cannot be mapped, every read throws
+    //
+
+    if (_size == 0)
+	return;
+
+    _mapping = CreateFileMappingA (_file, 0, PAGE_READONLY, 0, 0, 0);
+
+    if (_mapping)
+	_base = (char *) MapViewOfFile (_mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (_base == 0)
+    {
+	if (_mapping)
+	    CloseHandle (_mapping);
+
+	CloseHandle (_file);
+	THROW (Iex::InputExc, "Cannot memory-map file \"" <<
+			      fileName << "\".");
+    }
+}
+
+
+MmapIStream::~MmapIStream ()
+{
+    if (_base)
+	UnmapViewOfFile (_base);
+
+    if (_mapping)
+	CloseHandle (_mapping);
+
+    CloseHandle (_file);
+}
+
+#else
+
+MmapIStream::MmapIStream (const char fileName[]):
+    IStream (fileName),
+    _base (0),
+    _size (0),
+    _pos (0)
+{
+    int fd = ::open (fileName, O_RDONLY);
+
+    if (fd < 0)
+	Iex::throwErrnoExc();
+
+    struct stat st;
+
+    if (fstat (fd, &st) < 0)
+    {
+	int err = errno;
+	::close (fd);
+	Iex::throwErrnoExc ("%T.", err);
+    }
+
+    _size = st.st_size;
+
+    //
+    // Empty files cannot be mapped, every read throws
+    //
+
+    if (_size > 0)
+    {
+	void *base = mmap (0, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	if (base == MAP_FAILED)
+	{
+	    int err = errno;
+	    ::close (fd);
+	    Iex::throwErrnoExc ("%T.", err);
+	}
+
+	_base = (char *) base;
+    }
+
+    //
+    // The mapping stays valid after the file is closed
+    //
+
+    ::close (fd);
+}
+
+
+MmapIStream::~MmapIStream ()
+{
+    if (_base)
+	munmap (_base, _size);
+}
+
+#endif
+
+
+bool
+MmapIStream::isMemoryMapped () const
+{
+    return true;
+}
+
+
+bool
+MmapIStream::read (char c[/*n*/], int n)
+{
+    memcpy (c, readMemoryMapped (n), n);
+    return _pos < _size;
+}
+
+
+char *
+MmapIStream::readMemoryMapped (int n)
+{
+    if (n < 0 || _pos > _size || Int64 (n) > _size - _pos)
+	throw Iex::InputExc ("Unexpected end of file.");
+
+    char *data = _base + _pos;
+    _pos += n;
+    return data;
+}
+
+
+Int64
+MmapIStream::tellg ()
+{
+    return _pos;
+}
+
+
+void
+MmapIStream::seekg (Int64 pos)
+{
+    //
+    // Seeking past the end is allowed, the next read throws
+    //
+
+    _pos = pos;
+}
+
+
+Int64
+MmapIStream::size () const
+{
+    return _size;
+}
+
+
+} // namespace Imf
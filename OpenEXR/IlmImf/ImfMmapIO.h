@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2005, Industrial Light & Magic, a division of Lucas
+// Digital Ltd. LLC
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// *       Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// *       Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+// *       Neither the name of Industrial Light & Magic nor the names of
+// its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_IMF_MMAP_IO_H
+#define INCLUDED_IMF_MMAP_IO_H
+
+//-----------------------------------------------------------------------------
+//
+//	Low-level file input for OpenEXR based on memory-mapped files.
+//
+//	MmapIStream maps the whole file into memory when it is opened.
+//	It reports itself as memory-mapped, so ScanLineInputFile and
+//	TiledInputFile do not allocate line or tile buffers; compressors
+//	read the pixel data of each block in place, and seeking to a tile
+//	is a pointer assignment rather than a trip through an iostream.
+//
+//	Usage:
+//
+//	    MmapIStream is ("texture.exr");
+//	    TiledInputFile in (is);
+//
+//	The stream must outlive the file objects that read from it.
+//
+//-----------------------------------------------------------------------------
+
+#include <ImfIO.h>
+
+namespace Imf {
+
+//-------------------------------------------------
+// class MmapIStream -- an implementation of class
+// IStream based on a memory-mapped, read-only file
+//-------------------------------------------------
+
+class MmapIStream: public IStream
+{
+  public:
+
+    //-------------------------------------------------------
+    // A constructor that opens and maps the file with the
+    // given name.  The destructor will unmap and close it.
+    //-------------------------------------------------------
+
+    MmapIStream (const char fileName[]);
+
+    virtual ~MmapIStream ();
+
+    virtual bool	isMemoryMapped () const;
+    virtual bool	read (char c[/*n*/], int n);
+    virtual char *	readMemoryMapped (int n);
+    virtual Int64	tellg ();
+    virtual void	seekg (Int64 pos);
+
+
+    //-----------------------------
+    // Size of the file, in bytes.
+    //-----------------------------
+
+    Int64		size () const;
+
+  private:
+
+    char *		_base;
+    Int64		_size;
+    Int64		_pos;
+
+    #if defined _WIN32 || defined _WIN64
+	void *		_file;
+	void *		_mapping;
+    #endif
+};
+
+
+} // namespace Imf
+
+#endif
@@ -1203,6 +1203,25 @@ RgbaInputFile::readPixels (int scanLine)
 }
 
 
+void	
+RgbaInputFile::readAllPixels ()
+{
+    if (_fromYca)
+    {
+	//
+	// Luminance/chroma files are converted a few scan
+	// lines at a time, there is nothing to gain.
+	//
+
+	readPixels (dataWindow().min.y, dataWindow().max.y);
+    }
+    else
+    {
+	_inputFile->readAllPixels ();
+    }
+}
+
+
 bool
 RgbaInputFile::isComplete () const
 {
@@ -46,12 +46,248 @@
 #include <assert.h>
 #include <algorithm>
 
+#if defined (__SSE2__) || defined (_M_X64) || \
+    (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define IMF_YCA_SSE2 1
+    #include <emmintrin.h>
+#endif
+
 using namespace Imath;
 using namespace std;
 
 namespace Imf {
 namespace RgbaYca {
 
+#ifdef IMF_YCA_SSE2
+
+namespace {
+
+//
+// SSE2 versions of RGBAtoYCA() and YCAtoRGBA().  They work on four
+// pixels at a time, in blocks of BLOCK pixels that are converted from
+// half to float with halfToFloatArray() and back with floatToHalfArray(),
+// and produce the same results as the scalar code.
+//
+
+const int BLOCK = 64;
+
+inline __m128
+select (__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps (_mm_and_ps (mask, a), _mm_andnot_ps (mask, b));
+}
+
+
+inline __m128
+absLessThanHalfMaxTimes (__m128 d, __m128 y)
+{
+    //
+    // abs (d) < HALF_MAX * y, at the precision the scalar code uses;
+    // HALF_MAX is a double on some platforms and a float on others.
+    //
+
+    __m128 ad = _mm_andnot_ps (_mm_set1_ps (-0.0f), d);
+
+    if (sizeof (HALF_MAX) == sizeof (float))
+	return _mm_cmplt_ps (ad, _mm_mul_ps (_mm_set1_ps (HALF_MAX), y));
+
+    __m128d h = _mm_set1_pd (HALF_MAX);
+
+    __m128d lo = _mm_cmplt_pd (_mm_cvtps_pd (ad),
+			       _mm_mul_pd (h, _mm_cvtps_pd (y)));
+
+    __m128d hi = _mm_cmplt_pd (_mm_cvtps_pd (_mm_movehl_ps (ad, ad)),
+			       _mm_mul_pd (h, _mm_cvtps_pd (_mm_movehl_ps (y, y))));
+
+    return _mm_shuffle_ps (_mm_castpd_ps (lo), _mm_castpd_ps (hi),
+			   _MM_SHUFFLE (2, 0, 2, 0));
+}
+
+
+void
+RGBAtoYCA_SSE2 (const V3f &yw,
+		int n,
+		bool aIsValid,
+		const Rgba rgbaIn[/*n*/],
+		Rgba ycaOut[/*n*/])
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps (1);
+    const __m128 inf = _mm_set1_ps (half::posInf());
+    const __m128 ywx = _mm_set1_ps (yw.x);
+    const __m128 ywy = _mm_set1_ps (yw.y);
+    const __m128 ywz = _mm_set1_ps (yw.z);
+
+    for (int i0 = 0; i0 < n; i0 += BLOCK)
+    {
+	int m = min (BLOCK, n - i0);
+	Rgba in[BLOCK];
+	float f[4 * BLOCK];
+
+	copy (rgbaIn + i0, rgbaIn + i0 + m, in);
+	halfToFloatArray (&in[0].r, f, 4 * m);
+
+	for (int k = 4 * m; k < 4 * ((m + 3) & ~3); ++k)
+	    f[k] = 0;
+
+	for (int i = 0; i < 4 * m; i += 16)
+	{
+	    __m128 r = _mm_loadu_ps (f + i);
+	    __m128 g = _mm_loadu_ps (f + i + 4);
+	    __m128 b = _mm_loadu_ps (f + i + 8);
+	    __m128 a = _mm_loadu_ps (f + i + 12);
+
+	    _MM_TRANSPOSE4_PS (r, g, b, a);
+
+	    //
+	    // Replace negative, infinite and NaN R, G and B with 0
+	    //
+
+	    r = _mm_and_ps (r, _mm_and_ps (_mm_cmpge_ps (r, zero),
+					   _mm_cmplt_ps (r, inf)));
+
+	    g = _mm_and_ps (g, _mm_and_ps (_mm_cmpge_ps (g, zero),
+					   _mm_cmplt_ps (g, inf)));
+
+	    b = _mm_and_ps (b, _mm_and_ps (_mm_cmpge_ps (b, zero),
+					   _mm_cmplt_ps (b, inf)));
+
+	    __m128 equal = _mm_and_ps (_mm_cmpeq_ps (r, g),
+				       _mm_cmpeq_ps (g, b));
+
+	    __m128 Y = _mm_add_ps (_mm_add_ps (_mm_mul_ps (r, ywx),
+					       _mm_mul_ps (g, ywy)),
+				   _mm_mul_ps (b, ywz));
+
+	    __m128 dr = _mm_sub_ps (r, Y);
+	    __m128 db = _mm_sub_ps (b, Y);
+
+	    __m128 ry = _mm_and_ps (absLessThanHalfMaxTimes (dr, Y),
+				    _mm_div_ps (dr, Y));
+
+	    __m128 by = _mm_and_ps (absLessThanHalfMaxTimes (db, Y),
+				    _mm_div_ps (db, Y));
+
+	    r = _mm_andnot_ps (equal, ry);
+	    g = select (equal, g, Y);
+	    b = _mm_andnot_ps (equal, by);
+
+	    if (!aIsValid)
+		a = one;
+
+	    _MM_TRANSPOSE4_PS (r, g, b, a);
+
+	    _mm_storeu_ps (f + i, r);
+	    _mm_storeu_ps (f + i + 4, g);
+	    _mm_storeu_ps (f + i + 8, b);
+	    _mm_storeu_ps (f + i + 12, a);
+	}
+
+	floatToHalfArray (f, &ycaOut[i0].r, 4 * m);
+
+	//
+	// The conversion to float and back loses the sign of negative
+	// zeroes; the scalar code copies A, and G if R, G and B are
+	// equal, without converting them.
+	//
+
+	for (int i = 0; i < m; ++i)
+	{
+	    if (aIsValid)
+		ycaOut[i0 + i].a = in[i].a;
+
+	    if (in[i].g.bits() == 0x8000 &&
+		!(in[i].r.isFinite() && in[i].r > 0) &&
+		!(in[i].b.isFinite() && in[i].b > 0))
+	    {
+		ycaOut[i0 + i].g = in[i].g;
+	    }
+	}
+    }
+}
+
+
+void
+YCAtoRGBA_SSE2 (const V3f &yw,
+		int n,
+		const Rgba ycaIn[/*n*/],
+		Rgba rgbaOut[/*n*/])
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps (1);
+    const __m128 ywx = _mm_set1_ps (yw.x);
+    const __m128 ywy = _mm_set1_ps (yw.y);
+    const __m128 ywz = _mm_set1_ps (yw.z);
+
+    for (int i0 = 0; i0 < n; i0 += BLOCK)
+    {
+	int m = min (BLOCK, n - i0);
+	Rgba in[BLOCK];
+	float f[4 * BLOCK];
+
+	copy (ycaIn + i0, ycaIn + i0 + m, in);
+	halfToFloatArray (&in[0].r, f, 4 * m);
+
+	for (int k = 4 * m; k < 4 * ((m + 3) & ~3); ++k)
+	    f[k] = 0;
+
+	for (int i = 0; i < 4 * m; i += 16)
+	{
+	    __m128 ry = _mm_loadu_ps (f + i);
+	    __m128 Y = _mm_loadu_ps (f + i + 4);
+	    __m128 by = _mm_loadu_ps (f + i + 8);
+	    __m128 a = _mm_loadu_ps (f + i + 12);
+
+	    _MM_TRANSPOSE4_PS (ry, Y, by, a);
+
+	    __m128 gray = _mm_and_ps (_mm_cmpeq_ps (ry, zero),
+				      _mm_cmpeq_ps (by, zero));
+
+	    __m128 r = _mm_mul_ps (_mm_add_ps (ry, one), Y);
+	    __m128 b = _mm_mul_ps (_mm_add_ps (by, one), Y);
+
+	    __m128 g = _mm_div_ps (_mm_sub_ps (_mm_sub_ps (Y, _mm_mul_ps (r, ywx)),
+					       _mm_mul_ps (b, ywz)),
+				   ywy);
+
+	    r = select (gray, Y, r);
+	    g = select (gray, Y, g);
+	    b = select (gray, Y, b);
+
+	    _MM_TRANSPOSE4_PS (r, g, b, a);
+
+	    _mm_storeu_ps (f + i, r);
+	    _mm_storeu_ps (f + i + 4, g);
+	    _mm_storeu_ps (f + i + 8, b);
+	    _mm_storeu_ps (f + i + 12, a);
+	}
+
+	floatToHalfArray (f, &rgbaOut[i0].r, 4 * m);
+
+	//
+	// Restore the sign of negative zeroes in the values that the
+	// scalar code copies without converting them.
+	//
+
+	for (int i = 0; i < m; ++i)
+	{
+	    rgbaOut[i0 + i].a = in[i].a;
+
+	    if (in[i].g.bits() == 0x8000 && in[i].r == 0 && in[i].b == 0)
+	    {
+		rgbaOut[i0 + i].r = in[i].g;
+		rgbaOut[i0 + i].g = in[i].g;
+		rgbaOut[i0 + i].b = in[i].g;
+	    }
+	}
+    }
+}
+
+
+} // namespace
+
+#endif
+
 
 V3f
 computeYw (const Chromaticities &cr)
@@ -68,6 +304,12 @@ RGBAtoYCA (const V3f &yw,
 	   const Rgba rgbaIn[/*n*/],
 	   Rgba ycaOut[/*n*/])
 {
+    #ifdef IMF_YCA_SSE2
+
+	RGBAtoYCA_SSE2 (yw, n, aIsValid, rgbaIn, ycaOut);
+
+    #else
+
     for (int i = 0; i < n; ++i)
     {
 	Rgba in = rgbaIn[i];
@@ -125,6 +367,8 @@ RGBAtoYCA (const V3f &yw,
 	else
 	    out.a = 1;
     }
+
+    #endif
 }
 
 
@@ -359,6 +603,12 @@ YCAtoRGBA (const Imath::V3f &yw,
 	   const Rgba ycaIn[/*n*/],
 	   Rgba rgbaOut[/*n*/])
 {
+    #ifdef IMF_YCA_SSE2
+
+	YCAtoRGBA_SSE2 (yw, n, ycaIn, rgbaOut);
+
+    #else
+
     for (int i = 0; i < n; ++i)
     {
 	const Rgba &in = ycaIn[i];
@@ -394,6 +644,8 @@ YCAtoRGBA (const Imath::V3f &yw,
 	    out.a = in.a;
 	}
     }
+
+    #endif
 }
 
 
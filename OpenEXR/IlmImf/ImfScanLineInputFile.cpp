@@ -56,6 +56,7 @@
 #include <string>
 #include <vector>
 #include <assert.h>
+#include <limits.h>
 #include <algorithm> // for std::min std::max
 
 
@@ -404,6 +405,7 @@ class LineBufferTask : public Task
     LineBufferTask (TaskGroup *group,
                     ScanLineInputFile::Data *ifd,
 		    LineBuffer *lineBuffer,
+		    const char *pixelData,
                     int scanLineMin,
 		    int scanLineMax);
 
@@ -415,6 +417,7 @@ class LineBufferTask : public Task
 
     ScanLineInputFile::Data *	_ifd;
     LineBuffer *		_lineBuffer;
+    const char *		_pixelData;
     int				_scanLineMin;
     int				_scanLineMax;
 };
@@ -424,12 +427,14 @@ LineBufferTask::LineBufferTask
     (TaskGroup *group,
      ScanLineInputFile::Data *ifd,
      LineBuffer *lineBuffer,
+     const char *pixelData,
      int scanLineMin,
      int scanLineMax)
 :
     Task (group),
     _ifd (ifd),
     _lineBuffer (lineBuffer),
+    _pixelData (pixelData),
     _scanLineMin (scanLineMin),
     _scanLineMax (scanLineMax)
 {
@@ -474,7 +479,7 @@ LineBufferTask::execute ()
                 _lineBuffer->format = _lineBuffer->compressor->format();
 
                 _lineBuffer->dataSize = _lineBuffer->compressor->uncompress
-                    (_lineBuffer->buffer, _lineBuffer->dataSize,
+                    (_pixelData, _lineBuffer->dataSize,
 		     _lineBuffer->minY, _lineBuffer->uncompressedData);
             }
             else
@@ -485,7 +490,7 @@ LineBufferTask::execute ()
                 //
     
                 _lineBuffer->format = Compressor::XDR;
-                _lineBuffer->uncompressedData = _lineBuffer->buffer;
+                _lineBuffer->uncompressedData = _pixelData;
             }
         }
         
@@ -645,10 +650,60 @@ newLineBufferTask
     scanLineMin = max (lineBuffer->minY, scanLineMin);
     scanLineMax = min (lineBuffer->maxY, scanLineMax);
 
-    return new LineBufferTask (group, ifd, lineBuffer,
+    return new LineBufferTask (group, ifd, lineBuffer, lineBuffer->buffer,
 			       scanLineMin, scanLineMax);
 }
 
+
+void
+rethrowLineBufferException (ScanLineInputFile::Data *ifd)
+{
+    //
+    // LineBufferTask::execute() may have encountered exceptions, but
+    // those exceptions occurred in another thread, not in the thread
+    // that is executing this call to ScanLineInputFile::readPixels().
+    // LineBufferTask::execute() has caught all exceptions and stored
+    // the exceptions' what() strings in the line buffers.
+    // Now we check if any line buffer contains a stored exception; if
+    // this is the case then we re-throw the exception in this thread.
+    // (It is possible that multiple line buffers contain stored
+    // exceptions.  We re-throw the first exception we find and
+    // ignore all others.)
+    //
+
+    const string *exception = 0;
+
+    for (size_t i = 0; i < ifd->lineBuffers.size(); ++i)
+    {
+	LineBuffer *lineBuffer = ifd->lineBuffers[i];
+
+	if (lineBuffer->hasException && !exception)
+	    exception = &lineBuffer->exception;
+
+	lineBuffer->hasException = false;
+    }
+
+    if (exception)
+	throw Iex::IoExc (*exception);
+}
+
+
+//
+// The location of a line buffer's raw data in the file
+//
+
+struct ChunkInFile
+{
+    Int64	offset;
+    int		number;
+
+    bool operator < (const ChunkInFile &other) const
+    {
+	return offset < other.offset;
+    }
+};
+
+
 } // namespace
 
 
@@ -936,34 +991,188 @@ ScanLineInputFile::readPixels (int scanLine1, int scanLine2)
         }
         
 	//
-	// Exeption handling:
+	// Exeption handling
+	//
+
+	rethrowLineBufferException (_data);
+    }
+    catch (Iex::BaseExc &e)
+    {
+	REPLACE_EXC (e, "Error reading pixel data from image "
+		        "file \"" << fileName() << "\". " << e);
+	throw;
+    }
+}
+
+
+void	
+ScanLineInputFile::readPixels (int scanLine)
+{
+    readPixels (scanLine, scanLine);
+}
+
+
+void
+ScanLineInputFile::readAllPixels ()
+{
+    //
+    // Incomplete files may have line buffers missing;
+    // read what is there the usual way.
+    //
+
+    if (!_data->fileIsComplete)
+    {
+	readPixels (_data->minY, _data->maxY);
+	return;
+    }
+
+    bool fallBack = false;
+
+    try
+    {
+        Lock lock (*_data);
+
+	if (_data->slices.size() == 0)
+	    throw Iex::ArgExc ("No frame buffer specified "
+			       "as pixel data destination.");
+
 	//
-	// LineBufferTask::execute() may have encountered exceptions, but
-	// those exceptions occurred in another thread, not in the thread
-	// that is executing this call to ScanLineInputFile::readPixels().
-	// LineBufferTask::execute() has caught all exceptions and stored
-	// the exceptions' what() strings in the line buffers.
-	// Now we check if any line buffer contains a stored exception; if
-	// this is the case then we re-throw the exception in this thread.
-	// (It is possible that multiple line buffers contain stored
-	// exceptions.  We re-throw the first exception we find and
-	// ignore all others.)
+	// Sort the line buffers by their position in the file.  The
+	// raw data of all line buffers is one contiguous range of
+	// the file, from the first line buffer to the end of the last.
 	//
 
-	const string *exception = 0;
+	const int headerSize = 2 * Xdr::size<int>();
+	const int numChunks = (int) _data->lineOffsets.size();
+
+	vector<ChunkInFile> chunks (numChunks);
 
-        for (int i = 0; i < _data->lineBuffers.size(); ++i)
+	for (int i = 0; i < numChunks; ++i)
 	{
-            LineBuffer *lineBuffer = _data->lineBuffers[i];
+	    chunks[i].offset = _data->lineOffsets[i];
+	    chunks[i].number = i;
+	}
 
-	    if (lineBuffer->hasException && !exception)
-		exception = &lineBuffer->exception;
+	std::sort (chunks.begin(), chunks.end());
 
-	    lineBuffer->hasException = false;
+	Int64 first = chunks.front().offset;
+	_data->is->seekg (chunks.back().offset);
+	_data->nextLineBufferMinY = _data->minY - 1;
+
+	int yInFile = 0;
+	int lastSize = -1;
+	Xdr::read <StreamIO> (*_data->is, yInFile);
+	Xdr::read <StreamIO> (*_data->is, lastSize);
+
+	Int64 last = chunks.back().offset + headerSize + lastSize;
+
+	//
+	// Let readPixels() deal with line offset tables that
+	// do not look like they describe a contiguous range.
+	//
+
+	Int64 maxSize = Int64 (numChunks) *
+			(headerSize + _data->lineBufferSize);
+
+	if (lastSize < 0 || last <= first || last - first > maxSize ||
+	    last - first > Int64 (INT_MAX))
+	{
+	    fallBack = true;
 	}
+	else
+	{
+	    int size = int (last - first);
+	    int sizeRead = 0;
+	    const char *data = 0;
+	    vector<char> storage;
+
+	    _data->is->seekg (first);
+
+	    if (_data->is->isMemoryMapped ())
+	    {
+		data = _data->is->readMemoryMapped (size);
+		sizeRead = size;
+	    }
+	    else
+	    {
+		storage.resize (size);
+		data = &storage[0];
+	    }
+
+	    {
+		TaskGroup taskGroup;
+
+		//
+		// Read the file in large blocks.  As soon as a block is
+		// in, the line buffers it completes get their tasks, so
+		// they are uncompressed while the next block is read.
+		//
+
+		const int blockSize = max (int (_data->lineBufferSize), 1 << 22);
+
+		for (int c = 0; c < numChunks; ++c)
+		{
+		    Int64 begin = chunks[c].offset - first;
+
+		    while (Int64 (sizeRead) < begin + headerSize)
+		    {
+			int n = min (blockSize, size - sizeRead);
+			_data->is->read (&storage[0] + sizeRead, n);
+			sizeRead += n;
+		    }
+
+		    const char *readPtr = data + begin;
+		    int minY = _data->minY + chunks[c].number *
+					     _data->linesInBuffer;
+		    int dataSize;
+
+		    Xdr::read <CharPtrIO> (readPtr, yInFile);
+		    Xdr::read <CharPtrIO> (readPtr, dataSize);
+
+		    if (yInFile != minY)
+			throw Iex::InputExc ("Unexpected data block "
+					     "y coordinate.");
+
+		    if (dataSize < 0 ||
+			dataSize > (int) _data->lineBufferSize ||
+			begin + headerSize + dataSize > Int64 (size))
+		    {
+			throw Iex::InputExc ("Unexpected data block length.");
+		    }
+
+		    while (Int64 (sizeRead) < begin + headerSize + dataSize)
+		    {
+			int n = min (blockSize, size - sizeRead);
+			_data->is->read (&storage[0] + sizeRead, n);
+			sizeRead += n;
+		    }
+
+		    LineBuffer *lineBuffer =
+			_data->getLineBuffer (chunks[c].number);
+
+		    lineBuffer->wait ();
+
+		    lineBuffer->minY = minY;
+		    lineBuffer->maxY = minY + _data->linesInBuffer - 1;
+		    lineBuffer->dataSize = dataSize;
+		    lineBuffer->uncompressedData = 0;
+
+		    //
+		    // The raw data does not outlive this call, it
+		    // cannot be reused by later calls to readPixels().
+		    //
+
+		    lineBuffer->number = -1;
+
+		    ThreadPool::addGlobalTask (new LineBufferTask
+			(&taskGroup, _data, lineBuffer, readPtr,
+			 lineBuffer->minY, min (lineBuffer->maxY,
+						_data->maxY)));
+		}
+	    }
 
-	if (exception)
-	    throw Iex::IoExc (*exception);
+	    rethrowLineBufferException (_data);
+	}
     }
     catch (Iex::BaseExc &e)
     {
@@ -971,13 +1180,9 @@ ScanLineInputFile::readPixels (int scanLine1, int scanLine2)
 		        "file \"" << fileName() << "\". " << e);
 	throw;
     }
-}
 
-
-void	
-ScanLineInputFile::readPixels (int scanLine)
-{
-    readPixels (scanLine, scanLine);
+    if (fallBack)
+	readPixels (_data->minY, _data->maxY);
 }
 
 
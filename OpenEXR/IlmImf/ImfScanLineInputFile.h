@@ -149,6 +149,23 @@ class ScanLineInputFile
     void		readPixels (int scanLine);
 
 
+    //---------------------------------------------------------------
+    // Read all pixel data:
+    //
+    // readAllPixels() reads every scan line of the data window, like
+    // readPixels (dataWindow.min.y, dataWindow.max.y), but reads the
+    // raw data of the whole file in a few large sequential blocks
+    // instead of one line buffer at a time.  Line buffers are
+    // uncompressed in parallel as soon as their block has been
+    // read, while the following blocks are being read.
+    //
+    // The raw data of the file is held in memory until all scan
+    // lines are done, unless the file is memory-mapped.
+    //---------------------------------------------------------------
+
+    void		readAllPixels ();
+
+
     //----------------------------------------------
     // Read a block of raw pixel data from the file,
     // without uncompressing it (this function is
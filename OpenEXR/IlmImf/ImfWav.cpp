@@ -46,6 +46,12 @@
 
 #include <ImfWav.h>
 
+#if defined (__SSE2__) || defined (_M_X64) || \
+    (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define IMF_WAV_SSE2 1
+    #include <emmintrin.h>
+#endif
+
 namespace Imf {
 namespace {
 
@@ -132,6 +138,95 @@ wdec16 (unsigned short  l, unsigned short  h,
     a = aa;
 }
 
+#ifdef IMF_WAV_SSE2
+
+//
+// SSE2 versions of the basis functions, transforming eight pairs at
+// once.  16-bit lanes wrap exactly like the casts to short and the
+// masking with MOD_MASK above, so the results are bit for bit the same.
+//
+
+inline void
+wenc14x8 (__m128i a, __m128i b, __m128i &l, __m128i &h)
+{
+    //
+    // (a + b) >> 1 without overflowing 16 bits
+    //
+
+    l = _mm_add_epi16 (_mm_and_si128 (a, b),
+		       _mm_srai_epi16 (_mm_xor_si128 (a, b), 1));
+    h = _mm_sub_epi16 (a, b);
+}
+
+
+inline void
+wdec14x8 (__m128i l, __m128i h, __m128i &a, __m128i &b)
+{
+    __m128i ai = _mm_add_epi16
+	(l, _mm_add_epi16 (_mm_and_si128 (h, _mm_set1_epi16 (1)),
+			   _mm_srai_epi16 (h, 1)));
+    a = ai;
+    b = _mm_sub_epi16 (ai, h);
+}
+
+
+inline void
+wenc16x8 (__m128i a, __m128i b, __m128i &l, __m128i &h)
+{
+    const __m128i offset = _mm_set1_epi16 (short (A_OFFSET));
+
+    __m128i ao = _mm_xor_si128 (a, offset);
+
+    //
+    // Unsigned (ao + b) >> 1, and d < 0 as a signed compare of
+    // the offset values
+    //
+
+    __m128i m = _mm_add_epi16 (_mm_and_si128 (ao, b),
+			       _mm_srli_epi16 (_mm_xor_si128 (ao, b), 1));
+    __m128i neg = _mm_cmplt_epi16 (a, _mm_xor_si128 (b, offset));
+
+    l = _mm_xor_si128 (m, _mm_and_si128 (neg, offset));
+    h = _mm_sub_epi16 (ao, b);
+}
+
+
+inline void
+wdec16x8 (__m128i l, __m128i h, __m128i &a, __m128i &b)
+{
+    __m128i bb = _mm_sub_epi16 (l, _mm_srli_epi16 (h, 1));
+    a = _mm_xor_si128 (_mm_add_epi16 (h, bb), _mm_set1_epi16 (short (A_OFFSET)));
+    b = bb;
+}
+
+
+//
+// Load 16 adjacent values as their even and odd elements,
+// and store them back interleaved.
+//
+
+inline void
+loadPairs (const unsigned short *p, __m128i &even, __m128i &odd)
+{
+    __m128i v0 = _mm_loadu_si128 ((const __m128i *) p);
+    __m128i v1 = _mm_loadu_si128 ((const __m128i *) (p + 8));
+
+    even = _mm_packs_epi32 (_mm_srai_epi32 (_mm_slli_epi32 (v0, 16), 16),
+			    _mm_srai_epi32 (_mm_slli_epi32 (v1, 16), 16));
+    odd  = _mm_packs_epi32 (_mm_srai_epi32 (v0, 16),
+			    _mm_srai_epi32 (v1, 16));
+}
+
+
+inline void
+storePairs (unsigned short *p, __m128i even, __m128i odd)
+{
+    _mm_storeu_si128 ((__m128i *) p, _mm_unpacklo_epi16 (even, odd));
+    _mm_storeu_si128 ((__m128i *) (p + 8), _mm_unpackhi_epi16 (even, odd));
+}
+
+#endif
+
 } // namespace
 
 
@@ -176,6 +271,44 @@ wav2Encode
 	    unsigned short *px = py;
 	    unsigned short *ex = py + ox * (nx - p2);
 
+	    #ifdef IMF_WAV_SSE2
+
+		//
+		// On the first level of a single channel the quads are
+		// adjacent; transform eight of them at a time.
+		//
+
+		if (ox1 == 1)
+		{
+		    for (; px + 14 <= ex; px += 16)
+		    {
+			__m128i a, b, c, d, v00, v01, v10, v11;
+
+			loadPairs (px, a, b);
+			loadPairs (px + oy1, c, d);
+
+			if (w14)
+			{
+			    wenc14x8 (a, b, v00, v01);
+			    wenc14x8 (c, d, v10, v11);
+			    wenc14x8 (v00, v10, a, c);
+			    wenc14x8 (v01, v11, b, d);
+			}
+			else
+			{
+			    wenc16x8 (a, b, v00, v01);
+			    wenc16x8 (c, d, v10, v11);
+			    wenc16x8 (v00, v10, a, c);
+			    wenc16x8 (v01, v11, b, d);
+			}
+
+			storePairs (px, a, b);
+			storePairs (px + oy1, c, d);
+		    }
+		}
+
+	    #endif
+
 	    //
 	    // X loop
 	    //
@@ -307,6 +440,44 @@ wav2Decode
 	    unsigned short *px = py;
 	    unsigned short *ex = py + ox * (nx - p2);
 
+	    #ifdef IMF_WAV_SSE2
+
+		//
+		// On the first level of a single channel the quads are
+		// adjacent; transform eight of them at a time.
+		//
+
+		if (ox1 == 1)
+		{
+		    for (; px + 14 <= ex; px += 16)
+		    {
+			__m128i a, b, c, d, v00, v01, v10, v11;
+
+			loadPairs (px, a, b);
+			loadPairs (px + oy1, c, d);
+
+			if (w14)
+			{
+			    wdec14x8 (a, c, v00, v10);
+			    wdec14x8 (b, d, v01, v11);
+			    wdec14x8 (v00, v01, a, b);
+			    wdec14x8 (v10, v11, c, d);
+			}
+			else
+			{
+			    wdec16x8 (a, c, v00, v10);
+			    wdec16x8 (b, d, v01, v11);
+			    wdec16x8 (v00, v01, a, b);
+			    wdec16x8 (v10, v11, c, d);
+			}
+
+			storePairs (px, a, b);
+			storePairs (px + oy1, c, d);
+		    }
+		}
+
+	    #endif
+
 	    //
 	    // X loop
 	    //
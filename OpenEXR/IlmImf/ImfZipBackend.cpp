@@ -0,0 +1,262 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2005, Industrial Light & Magic, a division of Lucas
+// Digital Ltd. LLC
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// *       Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// *       Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+// *       Neither the name of Industrial Light & Magic nor the names of
+// its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+//-----------------------------------------------------------------------------
+//
+//	Deflate backends for ZIP and ZIPS compression
+//
+//-----------------------------------------------------------------------------
+
+#include <ImfZipBackend.h>
+#include "IlmThreadMutex.h"
+#include "Iex.h"
+#include "../../../../../OpenNURBS/ZLib/zlib.h"
+
+namespace Imf {
+
+using IlmThread::Mutex;
+using IlmThread::Lock;
+
+namespace {
+
+
+Mutex			backendMutex;
+ZipBackendFactory	backendFactory = 0;
+int			backendLevel = Z_DEFAULT_COMPRESSION;
+
+
+class ZlibBackend: public ZipBackend
+{
+  public:
+
+    virtual int
+    compress (const char *in, int inSize, char *out, int outSize, int level)
+    {
+	uLongf size = outSize;
+
+	if (Z_OK != ::compress2 ((Bytef *) out, &size,
+				 (const Bytef *) in, inSize, level))
+	{
+	    throw Iex::BaseExc ("Data compression (zlib) failed.");
+	}
+
+	return size;
+    }
+
+    virtual int
+    uncompress (const char *in, int inSize, char *out, int outSize)
+    {
+	uLongf size = outSize;
+
+	if (Z_OK != ::uncompress ((Bytef *) out, &size,
+				  (const Bytef *) in, inSize))
+	{
+	    throw Iex::InputExc ("Data decompression (zlib) failed.");
+	}
+
+	return size;
+    }
+};
+
+
+class FastZipBackend: public ZipBackend
+{
+  public:
+
+    FastZipBackend (): _deflateLevel (0), _deflateInit (false),
+		       _inflateInit (false) {}
+
+    virtual ~FastZipBackend ()
+    {
+	if (_deflateInit)
+	    deflateEnd (&_deflate);
+
+	if (_inflateInit)
+	    inflateEnd (&_inflate);
+    }
+
+    virtual int
+    compress (const char *in, int inSize, char *out, int outSize, int level)
+    {
+	if (_deflateInit && _deflateLevel != level)
+	{
+	    deflateEnd (&_deflate);
+	    _deflateInit = false;
+	}
+
+	if (!_deflateInit)
+	{
+	    //
+	    // Levels 1 and 2 only look for runs of the previous byte,
+	    // which is where predicted pixel data has most of its
+	    // redundancy.  A larger memLevel trades memory for speed.
+	    //
+
+	    _deflate.zalloc = Z_NULL;
+	    _deflate.zfree = Z_NULL;
+	    _deflate.opaque = Z_NULL;
+
+	    int strategy = (level == 1 || level == 2)?
+			   Z_RLE: Z_DEFAULT_STRATEGY;
+
+	    if (Z_OK != deflateInit2 (&_deflate, level, Z_DEFLATED,
+				      MAX_WBITS, 9, strategy))
+	    {
+		throw Iex::BaseExc ("Data compression (zlib) failed.");
+	    }
+
+	    _deflateInit = true;
+	    _deflateLevel = level;
+	}
+	else if (Z_OK != deflateReset (&_deflate))
+	{
+	    throw Iex::BaseExc ("Data compression (zlib) failed.");
+	}
+
+	_deflate.next_in = (Bytef *) in;
+	_deflate.avail_in = inSize;
+	_deflate.next_out = (Bytef *) out;
+	_deflate.avail_out = outSize;
+
+	if (Z_STREAM_END != deflate (&_deflate, Z_FINISH))
+	    throw Iex::BaseExc ("Data compression (zlib) failed.");
+
+	return outSize - _deflate.avail_out;
+    }
+
+    virtual int
+    uncompress (const char *in, int inSize, char *out, int outSize)
+    {
+	if (!_inflateInit)
+	{
+	    _inflate.zalloc = Z_NULL;
+	    _inflate.zfree = Z_NULL;
+	    _inflate.opaque = Z_NULL;
+	    _inflate.next_in = Z_NULL;
+	    _inflate.avail_in = 0;
+
+	    if (Z_OK != inflateInit (&_inflate))
+		throw Iex::InputExc ("Data decompression (zlib) failed.");
+
+	    _inflateInit = true;
+	}
+	else if (Z_OK != inflateReset (&_inflate))
+	{
+	    throw Iex::InputExc ("Data decompression (zlib) failed.");
+	}
+
+	_inflate.next_in = (Bytef *) in;
+	_inflate.avail_in = inSize;
+	_inflate.next_out = (Bytef *) out;
+	_inflate.avail_out = outSize;
+
+	if (Z_STREAM_END != inflate (&_inflate, Z_FINISH))
+	    throw Iex::InputExc ("Data decompression (zlib) failed.");
+
+	return outSize - _inflate.avail_out;
+    }
+
+  private:
+
+    z_stream	_deflate;
+    z_stream	_inflate;
+    int		_deflateLevel;
+    bool	_deflateInit;
+    bool	_inflateInit;
+};
+
+
+} // namespace
+
+
+ZipBackend::~ZipBackend ()
+{
+    // empty
+}
+
+
+ZipBackend *
+newZlibBackend ()
+{
+    return new ZlibBackend;
+}
+
+
+ZipBackend *
+newFastZipBackend ()
+{
+    return new FastZipBackend;
+}
+
+
+ZipBackendFactory
+zipBackendFactory ()
+{
+    Lock lock (backendMutex);
+    return backendFactory? backendFactory: newZlibBackend;
+}
+
+
+void
+setZipBackendFactory (ZipBackendFactory factory)
+{
+    Lock lock (backendMutex);
+    backendFactory = factory;
+}
+
+
+int
+zipCompressionLevel ()
+{
+    Lock lock (backendMutex);
+    return backendLevel;
+}
+
+
+void
+setZipCompressionLevel (int level)
+{
+    Lock lock (backendMutex);
+
+    if (level < Z_DEFAULT_COMPRESSION)
+	level = Z_DEFAULT_COMPRESSION;
+    else if (level > Z_BEST_COMPRESSION)
+	level = Z_BEST_COMPRESSION;
+
+    backendLevel = level;
+}
+
+
+} // namespace Imf
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2005, Industrial Light & Magic, a division of Lucas
+// Digital Ltd. LLC
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// *       Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// *       Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+// *       Neither the name of Industrial Light & Magic nor the names of
+// its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_IMF_ZIP_BACKEND_H
+#define INCLUDED_IMF_ZIP_BACKEND_H
+
+//-----------------------------------------------------------------------------
+//
+//	Deflate backends for ZIP and ZIPS compression
+//
+//	ZipCompressor hands the reordered and predicted pixel data to a
+//	ZipBackend, which turns it into a zlib (RFC 1950) stream and back.
+//	Whatever backend wrote a file, any zlib can read it, so switching
+//	backends or compression levels never affects compatibility.
+//
+//	Each compressor creates its own backend instance through the
+//	Imf-global backend factory, so backends can keep per-compressor
+//	state and need not be thread-safe.  The factory and the compression
+//	level are read when a compressor is created; changing them affects
+//	files opened afterwards.
+//
+//	Two backends are built in:
+//
+//	* newZlibBackend() calls zlib's compress2() and uncompress() for
+//	  every block.  This is the default.
+//
+//	* newFastZipBackend() keeps one deflate and one inflate stream per
+//	  compressor and only resets them between blocks, instead of
+//	  allocating and initializing new ones for every block.  At levels
+//	  1 and 2 it deflates with run-length matching only, which is much
+//	  faster on predicted pixel data at a small cost in file size.
+//
+//-----------------------------------------------------------------------------
+
+namespace Imf {
+
+
+class ZipBackend
+{
+  public:
+
+    virtual ~ZipBackend ();
+
+
+    //-----------------------------------------------------------------
+    // Compress inSize bytes at in into a zlib stream at out, which has
+    // room for outSize bytes.  level is 0 to 9, or -1 for the backend's
+    // default.  Returns the size of the stream; throws Iex::BaseExc if
+    // the data cannot be compressed.
+    //-----------------------------------------------------------------
+
+    virtual int		compress (const char *in,
+				  int inSize,
+				  char *out,
+				  int outSize,
+				  int level) = 0;
+
+
+    //-----------------------------------------------------------------
+    // Decompress the zlib stream of inSize bytes at in into out, which
+    // has room for outSize bytes.  Returns the uncompressed size;
+    // throws Iex::InputExc if the stream is corrupt or too large.
+    //-----------------------------------------------------------------
+
+    virtual int		uncompress (const char *in,
+				    int inSize,
+				    char *out,
+				    int outSize) = 0;
+};
+
+
+typedef ZipBackend *	(*ZipBackendFactory) ();
+
+
+//-----------------------------------------------------------------------------
+// Built-in backends
+//-----------------------------------------------------------------------------
+
+ZipBackend *		newZlibBackend ();
+ZipBackend *		newFastZipBackend ();
+
+
+//-----------------------------------------------------------------------------
+// Query and change the Imf-global backend factory; setting it to 0
+// restores the default, newZlibBackend.
+//-----------------------------------------------------------------------------
+
+ZipBackendFactory	zipBackendFactory ();
+void			setZipBackendFactory (ZipBackendFactory factory);
+
+
+//-----------------------------------------------------------------------------
+// Query and change the Imf-global deflate level used when writing ZIP
+// and ZIPS compressed files: 1 (fastest) to 9 (smallest), 0 (store
+// only) or -1 (zlib default, currently 6).  Values outside that range
+// are clamped.
+//-----------------------------------------------------------------------------
+
+int			zipCompressionLevel ();
+void			setZipCompressionLevel (int level);
+
+
+} // namespace Imf
+
+#endif
@@ -41,10 +41,189 @@
 //-----------------------------------------------------------------------------
 
 #include <ImfZipCompressor.h>
+#include <ImfZipBackend.h>
 #include "Iex.h"
-#include "../../../../../OpenNURBS/ZLib/zlib.h"
+
+#if defined (__SSE2__) || defined (_M_X64) || \
+    (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define IMF_ZIP_SSE2 1
+    #include <emmintrin.h>
+#endif
 
 namespace Imf {
+namespace {
+
+//
+// Split the bytes of the pixel data into two halves, the even bytes
+// go to the first half and the odd bytes to the second.
+//
+
+void
+interleave (const char *in, int size, char *out)
+{
+    char *t1 = out;
+    char *t2 = out + (size + 1) / 2;
+    const char *stop = in + size;
+
+    #ifdef IMF_ZIP_SSE2
+
+	const __m128i mask = _mm_set1_epi16 (0x00ff);
+
+	for (; in + 32 <= stop; in += 32, t1 += 16, t2 += 16)
+	{
+	    __m128i a = _mm_loadu_si128 ((const __m128i *) in);
+	    __m128i b = _mm_loadu_si128 ((const __m128i *) (in + 16));
+
+	    _mm_storeu_si128 ((__m128i *) t1,
+			      _mm_packus_epi16 (_mm_and_si128 (a, mask),
+						_mm_and_si128 (b, mask)));
+
+	    _mm_storeu_si128 ((__m128i *) t2,
+			      _mm_packus_epi16 (_mm_srli_epi16 (a, 8),
+						_mm_srli_epi16 (b, 8)));
+	}
+
+    #endif
+
+    while (true)
+    {
+	if (in < stop)
+	    *(t1++) = *(in++);
+	else
+	    break;
+
+	if (in < stop)
+	    *(t2++) = *(in++);
+	else
+	    break;
+    }
+}
+
+
+//
+// Inverse of interleave()
+//
+
+void
+deinterleave (const char *in, int size, char *out)
+{
+    const char *t1 = in;
+    const char *t2 = in + (size + 1) / 2;
+    char *stop = out + size;
+
+    #ifdef IMF_ZIP_SSE2
+
+	for (; out + 32 <= stop; out += 32, t1 += 16, t2 += 16)
+	{
+	    __m128i a = _mm_loadu_si128 ((const __m128i *) t1);
+	    __m128i b = _mm_loadu_si128 ((const __m128i *) t2);
+
+	    _mm_storeu_si128 ((__m128i *) out, _mm_unpacklo_epi8 (a, b));
+	    _mm_storeu_si128 ((__m128i *) (out + 16), _mm_unpackhi_epi8 (a, b));
+	}
+
+    #endif
+
+    while (true)
+    {
+	if (out < stop)
+	    *(out++) = *(t1++);
+	else
+	    break;
+
+	if (out < stop)
+	    *(out++) = *(t2++);
+	else
+	    break;
+    }
+}
+
+
+//
+// Replace every byte but the first with its difference to the
+// previous byte, plus 128.
+//
+
+void
+predictorEncode (char *data, int size)
+{
+    unsigned char *t = (unsigned char *) data + 1;
+    unsigned char *stop = (unsigned char *) data + size;
+    int p = t[-1];
+
+    #ifdef IMF_ZIP_SSE2
+
+	const __m128i bias = _mm_set1_epi8 ((char) 0x80);
+
+	for (; t + 16 <= stop; t += 16)
+	{
+	    __m128i v = _mm_loadu_si128 ((const __m128i *) t);
+	    __m128i prev = _mm_or_si128 (_mm_slli_si128 (v, 1),
+					 _mm_cvtsi32_si128 (p));
+	    p = t[15];
+
+	    _mm_storeu_si128 ((__m128i *) t,
+			      _mm_add_epi8 (_mm_sub_epi8 (v, prev), bias));
+	}
+
+    #endif
+
+    while (t < stop)
+    {
+	int d = int (t[0]) - p + (128 + 256);
+	p = t[0];
+	t[0] = d;
+	++t;
+    }
+}
+
+
+//
+// Inverse of predictorEncode(), a running sum of the differences
+//
+
+void
+predictorDecode (char *data, int size)
+{
+    unsigned char *t = (unsigned char *) data + 1;
+    unsigned char *stop = (unsigned char *) data + size;
+
+    #ifdef IMF_ZIP_SSE2
+
+	const __m128i bias = _mm_set1_epi8 ((char) 0x80);
+	__m128i p = _mm_set1_epi8 ((char) t[-1]);
+
+	for (; t + 16 <= stop; t += 16)
+	{
+	    //
+	    // Prefix sum of the 16 differences in log2(16) steps,
+	    // then add the last byte of the previous group.
+	    //
+
+	    __m128i v = _mm_sub_epi8 (_mm_loadu_si128 ((const __m128i *) t),
+				      bias);
+
+	    v = _mm_add_epi8 (v, _mm_slli_si128 (v, 1));
+	    v = _mm_add_epi8 (v, _mm_slli_si128 (v, 2));
+	    v = _mm_add_epi8 (v, _mm_slli_si128 (v, 4));
+	    v = _mm_add_epi8 (v, _mm_slli_si128 (v, 8));
+	    v = _mm_add_epi8 (v, p);
+
+	    _mm_storeu_si128 ((__m128i *) t, v);
+	    p = _mm_set1_epi8 ((char) t[15]);
+	}
+
+    #endif
+
+    while (t < stop)
+    {
+	int d = int (t[-1]) + int (t[0]) - 128;
+	t[0] = d;
+	++t;
+    }
+}
+
+} // namespace
 
 
 ZipCompressor::ZipCompressor
@@ -56,7 +235,9 @@ ZipCompressor::ZipCompressor
     _maxScanLineSize (maxScanLineSize),
     _numScanLines (numScanLines),
     _tmpBuffer (0),
-    _outBuffer (0)
+    _outBuffer (0),
+    _backend (zipBackendFactory() ()),
+    _level (zipCompressionLevel())
 {
     _tmpBuffer =
 	new char [maxScanLineSize * numScanLines];
@@ -70,6 +251,7 @@ ZipCompressor::~ZipCompressor ()
 {
     delete [] _tmpBuffer;
     delete [] _outBuffer;
+    delete _backend;
 }
 
 
@@ -100,54 +282,21 @@ ZipCompressor::compress (const char *inPtr,
     // Reorder the pixel data.
     //
 
-    {
-	char *t1 = _tmpBuffer;
-	char *t2 = _tmpBuffer + (inSize + 1) / 2;
-	const char *stop = inPtr + inSize;
-
-	while (true)
-	{
-	    if (inPtr < stop)
-		*(t1++) = *(inPtr++);
-	    else
-		break;
-
-	    if (inPtr < stop)
-		*(t2++) = *(inPtr++);
-	    else
-		break;
-	}
-    }
+    interleave (inPtr, inSize, _tmpBuffer);
 
     //
     // Predictor.
     //
 
-    {
-	unsigned char *t = (unsigned char *) _tmpBuffer + 1;
-	unsigned char *stop = (unsigned char *) _tmpBuffer + inSize;
-	int p = t[-1];
-
-	while (t < stop)
-	{
-	    int d = int (t[0]) - p + (128 + 256);
-	    p = t[0];
-	    t[0] = d;
-	    ++t;
-	}
-    }
+    predictorEncode (_tmpBuffer, inSize);
 
     //
-    // Compress the data using zlib
+    // Compress the data
     //
 
-    uLongf outSize = int(ceil(inSize * 1.01)) + 100;
-
-    if (Z_OK != ::compress ((Bytef *)_outBuffer, &outSize,
-			    (const Bytef *) _tmpBuffer, inSize))
-    {
-	throw Iex::BaseExc ("Data compression (zlib) failed.");
-    }
+    int outSize = _backend->compress (_tmpBuffer, inSize, _outBuffer,
+				      int (ceil (inSize * 1.01)) + 100,
+				      _level);
 
     outPtr = _outBuffer;
     return outSize;
@@ -171,56 +320,23 @@ ZipCompressor::uncompress (const char *inPtr,
     }
 
     //
-    // Decompress the data using zlib
+    // Decompress the data
     //
 
-    uLongf outSize = _maxScanLineSize * _numScanLines;
-
-    if (Z_OK != ::uncompress ((Bytef *)_tmpBuffer, &outSize,
-			      (const Bytef *) inPtr, inSize))
-    {
-	throw Iex::BaseExc ("Data decompression (zlib) failed.");
-    }
+    int outSize = _backend->uncompress (inPtr, inSize, _tmpBuffer,
+					_maxScanLineSize * _numScanLines);
 
     //
     // Predictor.
     //
 
-    {
-	unsigned char *t = (unsigned char *) _tmpBuffer + 1;
-	unsigned char *stop = (unsigned char *) _tmpBuffer + outSize;
-
-	while (t < stop)
-	{
-	    int d = int (t[-1]) + int (t[0]) - 128;
-	    t[0] = d;
-	    ++t;
-	}
-    }
+    predictorDecode (_tmpBuffer, outSize);
 
     //
     // Reorder the pixel data.
     //
 
-    {
-	const char *t1 = _tmpBuffer;
-	const char *t2 = _tmpBuffer + (outSize + 1) / 2;
-	char *s = _outBuffer;
-	char *stop = s + outSize;
-
-	while (true)
-	{
-	    if (s < stop)
-		*(s++) = *(t1++);
-	    else
-		break;
-
-	    if (s < stop)
-		*(s++) = *(t2++);
-	    else
-		break;
-	}
-    }
+    deinterleave (_tmpBuffer, outSize, _outBuffer);
 
     outPtr = _outBuffer;
     return outSize;
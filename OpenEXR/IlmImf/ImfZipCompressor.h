@@ -47,6 +47,8 @@
 
 namespace Imf {
 
+class ZipBackend;
+
 
 class ZipCompressor: public Compressor
 {
@@ -72,6 +74,8 @@ class ZipCompressor: public Compressor
     int		_numScanLines;
     char *	_tmpBuffer;
     char *	_outBuffer;
+    ZipBackend *	_backend;
+    int		_level;
 };
 
 
@@ -0,0 +1,79 @@
+/**
+Copyright 2014-2017 Robert McNeel and Associates
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**/
+
+//-----------------------------------------------------------------------------
+//
+//	Tests for IlmImf.
+//
+//	    IlmImfTest [test]
+//
+//	runs all tests, or only the one named. Scratch files are written to
+//	the directory in TEMP on Windows, TMPDIR or else /var/tmp elsewhere.
+//	The exit status is nonzero if any test fails.
+//
+//-----------------------------------------------------------------------------
+
+#include "testHalfToFloatRead.h"
+#include "testRgbaYca.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#define TEST(x) \
+    if (argc < 2 || !strcmp (argv[1], #x)) \
+    { \
+        ++run; \
+        if (!x (tempDir)) \
+            ++failed; \
+    }
+
+
+int
+main (int argc, char *argv[])
+{
+    #ifdef _WIN32
+	const char *temp = getenv ("TEMP");
+    #else
+	const char *temp = getenv ("TMPDIR");
+	if (temp == 0)
+	    temp = "/var/tmp";
+    #endif
+
+    std::string tempDir = temp ? temp : ".";
+
+    if (!tempDir.empty() && tempDir[tempDir.size() - 1] != '/' &&
+        tempDir[tempDir.size() - 1] != '\\')
+    {
+        tempDir += '/';
+    }
+
+    int run = 0;
+    int failed = 0;
+
+    TEST (testHalfToFloatRead);
+    TEST (testRgbaYca);
+
+    if (run == 0)
+    {
+        std::cerr << "No test named " << argv[1] << std::endl;
+        return 2;
+    }
+
+    std::cout << failed << " of " << run << " tests failed" << std::endl;
+    return failed ? 1 : 0;
+}
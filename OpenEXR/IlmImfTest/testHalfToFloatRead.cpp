@@ -0,0 +1,258 @@
+/**
+Copyright 2014-2017 Robert McNeel and Associates
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**/
+
+//-----------------------------------------------------------------------------
+//
+//	Checks reading HALF channels into FLOAT frame buffers.
+//
+//	copyIntoFrameBuffer() converts a whole row with halfToFloatArray()
+//	when the destination slice is contiguous, and one pixel at a time
+//	otherwise. This test writes every half bit pattern, including
+//	denormals, infinities and NaNs, to scan line and tiled files with
+//	several compressions and widths that are not multiples of 8. It then
+//	reads the files back through both paths and compares each value bit
+//	for bit with float (half).
+//
+//	Run from the IlmImfTest program.
+//
+//-----------------------------------------------------------------------------
+
+#include "testHalfToFloatRead.h"
+
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfInputFile.h>
+#include <ImfOutputFile.h>
+#include <ImfTiledInputFile.h>
+#include <ImfTiledOutputFile.h>
+#include <half.h>
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Imf;
+using namespace Imath;
+
+namespace {
+
+const int HEIGHT = 37;
+
+
+//
+// Pixel (x, y) holds bit pattern (y * width + x + offset) & 0xffff, so
+// a few rows of any width cover many patterns and the offsets cover all.
+//
+
+unsigned short
+pattern (int x, int y, int width, int offset)
+{
+    return (unsigned short) ((y * width + x + offset) & 0xffff);
+}
+
+
+void
+fillHalf (std::vector<half> &pixels, int width, int offset)
+{
+    pixels.resize (width * HEIGHT);
+
+    for (int y = 0; y < HEIGHT; ++y)
+        for (int x = 0; x < width; ++x)
+            pixels[y * width + x].setBits (pattern (x, y, width, offset));
+}
+
+
+void
+write (const char fileName[],
+       const std::vector<half> &pixels,
+       int width,
+       Compression compression,
+       bool tiled)
+{
+    Header header (width, HEIGHT);
+    header.compression() = compression;
+    header.channels().insert ("Y", Channel (HALF));
+
+    FrameBuffer fb;
+
+    fb.insert ("Y", Slice (HALF,
+                           (char *) &pixels[0],
+                           sizeof (half),
+                           sizeof (half) * width));
+
+    if (tiled)
+    {
+        header.setTileDescription (TileDescription (16, 8, ONE_LEVEL));
+
+        TiledOutputFile out (fileName, header);
+        out.setFrameBuffer (fb);
+        out.writeTiles (0, out.numXTiles() - 1, 0, out.numYTiles() - 1);
+    }
+    else
+    {
+        OutputFile out (fileName, header);
+        out.setFrameBuffer (fb);
+        out.writePixels (HEIGHT);
+    }
+}
+
+
+//
+// Reads channel Y into a float buffer with xStride floats between
+// pixels and returns the number of mismatches.
+//
+
+int
+readAndCompare (const char fileName[],
+                int width,
+                int offset,
+                int xStride,
+                bool tiled)
+{
+    std::vector<float> pixels (width * HEIGHT * xStride, -1.0f);
+
+    FrameBuffer fb;
+
+    fb.insert ("Y", Slice (FLOAT,
+                           (char *) &pixels[0],
+                           sizeof (float) * xStride,
+                           sizeof (float) * xStride * width));
+
+    if (tiled)
+    {
+        TiledInputFile in (fileName);
+        in.setFrameBuffer (fb);
+        in.readTiles (0, in.numXTiles() - 1, 0, in.numYTiles() - 1);
+    }
+    else
+    {
+        InputFile in (fileName);
+        in.setFrameBuffer (fb);
+        in.readPixels (0, HEIGHT - 1);
+    }
+
+    int bad = 0;
+
+    for (int y = 0; y < HEIGHT; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            half h;
+            h.setBits (pattern (x, y, width, offset));
+
+            float expected = h;
+            float got = pixels[(y * width + x) * xStride];
+
+            if (memcmp (&expected, &got, sizeof (float)) != 0)
+                ++bad;
+
+            //
+            // Padding between pixels must be left alone.
+            //
+
+            for (int i = 1; i < xStride; ++i)
+                if (pixels[(y * width + x) * xStride + i] != -1.0f)
+                    ++bad;
+        }
+    }
+
+    return bad;
+}
+
+} // namespace
+
+
+bool
+testHalfToFloatRead (const std::string &tempDir)
+{
+    std::cout << "Testing HALF to FLOAT conversion on read" << std::endl;
+
+    const std::string name = tempDir + "imf_test_half_to_float.exr";
+    const char *fileName = name.c_str();
+
+    const Compression compressions[] =
+    {
+        NO_COMPRESSION,
+        RLE_COMPRESSION,
+        ZIPS_COMPRESSION,
+        ZIP_COMPRESSION,
+        PIZ_COMPRESSION
+    };
+
+    const int widths[] = {1, 7, 8, 9, 61, 1771};
+
+    int failures = 0;
+
+    try
+    {
+        for (size_t c = 0; c < sizeof (compressions) / sizeof (compressions[0]); ++c)
+        {
+            for (size_t w = 0; w < sizeof (widths) / sizeof (widths[0]); ++w)
+            {
+                int width = widths[w];
+                int rows = (65536 + width * HEIGHT - 1) / (width * HEIGHT);
+
+                //
+                // Narrow images need several passes to see every pattern.
+                //
+
+                for (int pass = 0; pass < rows; ++pass)
+                {
+                    int offset = pass * width * HEIGHT;
+
+                    std::vector<half> pixels;
+                    fillHalf (pixels, width, offset);
+
+                    for (int tiled = 0; tiled < 2; ++tiled)
+                    {
+                        write (fileName, pixels, width,
+                               compressions[c], tiled != 0);
+
+                        for (int xStride = 1; xStride <= 2; ++xStride)
+                        {
+                            int bad = readAndCompare (fileName, width, offset,
+                                                      xStride, tiled != 0);
+
+                            if (bad)
+                            {
+                                printf ("compression %d, width %d, offset %d, "
+                                        "%s, xStride %d: %d mismatches\n",
+                                        (int) compressions[c], width, offset,
+                                        tiled ? "tiled" : "scan lines",
+                                        xStride, bad);
+                                ++failures;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "ERROR -- caught exception: " << e.what() << std::endl;
+        ++failures;
+    }
+
+    remove (fileName);
+
+    std::cout << (failures ? "failed" : "ok") << "\n" << std::endl;
+    return failures == 0;
+}
@@ -0,0 +1,398 @@
+/**
+Copyright 2014-2017 Robert McNeel and Associates
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**/
+
+//-----------------------------------------------------------------------------
+//
+//	Checks the luminance/chroma conversions in ImfRgbaYca.
+//
+//	RGBAtoYCA() and YCAtoRGBA() have SSE2 paths that must give the same
+//	results as the scalar loops, bit for bit. The scalar loops are
+//	repeated here as the reference and both are run over rows of smooth
+//	colors with special cases mixed in, and over rows of random bits.
+//	NaNs compare equal to NaNs.
+//
+//	The conversions, the chroma filters and a WRITE_YCA file round trip
+//	are also timed.
+//
+//-----------------------------------------------------------------------------
+
+#include "testRgbaYca.h"
+
+#include <ImfArray.h>
+#include <ImfRgbaFile.h>
+#include <ImfRgbaYca.h>
+#include <ImfThreading.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Imf;
+using namespace Imf::RgbaYca;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int ROW = 4096;
+const int PASSES = 100;
+const int RANDOM_ROWS = 3000;
+
+
+double
+seconds (Clock::time_point start)
+{
+    return std::chrono::duration<double> (Clock::now() - start).count();
+}
+
+
+//
+// Scalar RGBAtoYCA() and YCAtoRGBA(), as ImfRgbaYca.cpp has them
+// without SSE2.
+//
+
+void
+referenceRGBAtoYCA (const Imath::V3f &yw,
+                    int n,
+                    bool aIsValid,
+                    const Rgba rgbaIn[],
+                    Rgba ycaOut[])
+{
+    for (int i = 0; i < n; ++i)
+    {
+        Rgba in = rgbaIn[i];
+        Rgba &out = ycaOut[i];
+
+        if (!in.r.isFinite() || in.r < 0)
+            in.r = 0;
+
+        if (!in.g.isFinite() || in.g < 0)
+            in.g = 0;
+
+        if (!in.b.isFinite() || in.b < 0)
+            in.b = 0;
+
+        if (in.r == in.g && in.g == in.b)
+        {
+            out.r = 0;
+            out.g = in.g;
+            out.b = 0;
+        }
+        else
+        {
+            float Y = in.r * yw.x + in.g * yw.y + in.b * yw.z;
+
+            out.g = Y;
+
+            if (std::abs (in.r - Y) < HALF_MAX * Y)
+                out.r = (in.r - Y) / Y;
+            else
+                out.r = 0;
+
+            if (std::abs (in.b - Y) < HALF_MAX * Y)
+                out.b = (in.b - Y) / Y;
+            else
+                out.b = 0;
+        }
+
+        if (aIsValid)
+            out.a = in.a;
+        else
+            out.a = 1;
+    }
+}
+
+
+void
+referenceYCAtoRGBA (const Imath::V3f &yw,
+                    int n,
+                    const Rgba ycaIn[],
+                    Rgba rgbaOut[])
+{
+    for (int i = 0; i < n; ++i)
+    {
+        const Rgba &in = ycaIn[i];
+        Rgba &out = rgbaOut[i];
+
+        if (in.r == 0 && in.b == 0)
+        {
+            out.r = in.g;
+            out.g = in.g;
+            out.b = in.g;
+            out.a = in.a;
+        }
+        else
+        {
+            float Y =  in.g;
+            float r = (in.r + 1) * Y;
+            float b = (in.b + 1) * Y;
+            float g = (Y - r * yw.x - b * yw.z) / yw.y;
+
+            out.r = r;
+            out.g = g;
+            out.b = b;
+            out.a = in.a;
+        }
+    }
+}
+
+
+//
+// Pixels with smooth colors, a few grays and the occasional value out
+// of the usual range, so the special cases in the conversions are hit.
+//
+
+void
+makeRow (std::vector<Rgba> &row, int seed)
+{
+    srand (seed);
+    row.resize (ROW + N - 1);
+
+    for (size_t i = 0; i < row.size(); ++i)
+    {
+        float t = i * 0.01f;
+        Rgba &p = row[i];
+
+        p.r = 0.5f + 0.5f * sinf (t);
+        p.g = 0.5f + 0.5f * sinf (t * 1.3f);
+        p.b = 0.5f + 0.5f * sinf (t * 0.7f);
+        p.a = 1;
+
+        switch (rand() % 16)
+        {
+          case 0:
+            p.g = p.r;
+            p.b = p.r;
+            break;
+
+          case 1:
+            p.b = -0.25f;
+            break;
+
+          case 2:
+            p.r = 3000.0f;
+            break;
+        }
+    }
+}
+
+
+void
+makeRandomRow (std::vector<Rgba> &row)
+{
+    for (size_t i = 0; i < row.size(); ++i)
+    {
+        row[i].r.setBits ((unsigned short) (rand() & 0xffff));
+        row[i].g.setBits ((unsigned short) (rand() & 0xffff));
+        row[i].b.setBits ((unsigned short) (rand() & 0xffff));
+        row[i].a.setBits ((unsigned short) (rand() & 0xffff));
+    }
+}
+
+
+bool
+sameHalf (half a, half b)
+{
+    return a.bits() == b.bits() || (a.isNan() && b.isNan());
+}
+
+
+//
+// Returns the number of pixels of a and b that differ.
+//
+
+int
+compareRows (const std::vector<Rgba> &a, const std::vector<Rgba> &b, int n)
+{
+    int bad = 0;
+
+    for (int i = 0; i < n; ++i)
+    {
+        if (!sameHalf (a[i].r, b[i].r) || !sameHalf (a[i].g, b[i].g) ||
+            !sameHalf (a[i].b, b[i].b) || !sameHalf (a[i].a, b[i].a))
+        {
+            ++bad;
+        }
+    }
+
+    return bad;
+}
+
+
+//
+// Runs both conversions and their references on row and returns the
+// number of pixels that differ.
+//
+
+int
+checkRow (const Imath::V3f &yw, const std::vector<Rgba> &row, bool aIsValid)
+{
+    std::vector<Rgba> yca (ROW), ycaRef (ROW);
+    std::vector<Rgba> rgba (ROW), rgbaRef (ROW);
+
+    RGBAtoYCA (yw, ROW, aIsValid, &row[0], &yca[0]);
+    referenceRGBAtoYCA (yw, ROW, aIsValid, &row[0], &ycaRef[0]);
+
+    //
+    // Feed YCAtoRGBA() the input row as well, random bits cover cases
+    // RGBAtoYCA() never produces.
+    //
+
+    YCAtoRGBA (yw, ROW, &row[0], &rgba[0]);
+    referenceYCAtoRGBA (yw, ROW, &row[0], &rgbaRef[0]);
+
+    return compareRows (yca, ycaRef, ROW) + compareRows (rgba, rgbaRef, ROW);
+}
+
+
+template <class F>
+void
+time (const char *name, F f)
+{
+    Clock::time_point start = Clock::now();
+
+    for (int i = 0; i < PASSES; ++i)
+        f();
+
+    double t = seconds (start);
+
+    printf ("    %-24s %8.3f s  %8.1f Mpixel/s\n",
+            name, t, ROW * (double) PASSES / t / 1e6);
+}
+
+} // namespace
+
+
+bool
+testRgbaYca (const std::string &tempDir)
+{
+    std::cout << "Testing RGBA/YCA conversions" << std::endl;
+
+    const Imath::V3f yw (0.2126f, 0.7152f, 0.0722f);
+    int failures = 0;
+
+    std::vector<Rgba> rgba;
+    makeRow (rgba, 1);
+
+    failures += checkRow (yw, rgba, true);
+    failures += checkRow (yw, rgba, false);
+
+    srand (2);
+    std::vector<Rgba> random (ROW);
+
+    for (int i = 0; i < RANDOM_ROWS; ++i)
+    {
+        makeRandomRow (random);
+        failures += checkRow (yw, random, i % 2 == 0);
+    }
+
+    if (failures)
+        std::cout << "    " << failures << " pixels differ from the scalar code" << std::endl;
+
+    std::vector<Rgba> yca (rgba.size());
+    std::vector<Rgba> out (rgba.size());
+
+    std::vector<std::vector<Rgba> > lines (N, rgba);
+    const Rgba *linePtrs[N];
+
+    for (int i = 0; i < N; ++i)
+        linePtrs[i] = &lines[i][0];
+
+    time ("RGBAtoYCA", [&] () {
+        RGBAtoYCA (yw, ROW, true, &rgba[0], &yca[0]);
+    });
+
+    time ("YCAtoRGBA", [&] () {
+        YCAtoRGBA (yw, ROW, &yca[0], &out[0]);
+    });
+
+    time ("decimateChromaHoriz", [&] () {
+        decimateChromaHoriz (ROW, &rgba[0], &out[0]);
+    });
+
+    time ("decimateChromaVert", [&] () {
+        decimateChromaVert (ROW, linePtrs, &out[0]);
+    });
+
+    time ("reconstructChromaHoriz", [&] () {
+        reconstructChromaHoriz (ROW, &rgba[0], &out[0]);
+    });
+
+    time ("reconstructChromaVert", [&] () {
+        reconstructChromaVert (ROW, linePtrs, &out[0]);
+    });
+
+    //
+    // A luminance/chroma file round trip, single threaded so the
+    // conversions are not hidden behind compression threads.
+    //
+
+    const std::string name = tempDir + "imf_test_rgba_yca.exr";
+
+    try
+    {
+        int threads = globalThreadCount();
+        setGlobalThreadCount (0);
+
+        const int width = 1920;
+        const int height = 1080;
+
+        Array2D<Rgba> pixels (height, width);
+
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+                pixels[y][x] = rgba[(x + y * 7) % ROW];
+
+        Clock::time_point start = Clock::now();
+
+        {
+            RgbaOutputFile file (name.c_str(), width, height, WRITE_YCA);
+            file.setFrameBuffer (&pixels[0][0], 1, width);
+            file.writePixels (height);
+        }
+
+        double tWrite = seconds (start);
+        start = Clock::now();
+
+        {
+            RgbaInputFile file (name.c_str());
+            file.setFrameBuffer (&pixels[0][0], 1, width);
+            file.readPixels (0, height - 1);
+        }
+
+        double tRead = seconds (start);
+
+        printf ("    WRITE_YCA file           write %.3f s  read %.3f s\n",
+                tWrite, tRead);
+
+        setGlobalThreadCount (threads);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "ERROR -- caught exception: " << e.what() << std::endl;
+        ++failures;
+    }
+
+    remove (name.c_str());
+
+    std::cout << (failures ? "failed" : "ok") << "\n" << std::endl;
+    return failures == 0;
+}
@@ -0,0 +1,27 @@
+/**
+Copyright 2014-2017 Robert McNeel and Associates
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**/
+
+#pragma once
+
+#include <string>
+
+//
+// Returns true if the SSE2 paths of RGBAtoYCA() and YCAtoRGBA() match
+// the scalar code bit for bit. Scratch files go to tempDir, which ends
+// in a separator.
+//
+
+bool testRgbaYca (const std::string &tempDir);
@@ -43,24 +43,316 @@
 #include "IlmThreadSemaphore.h"
 #include "IlmThreadPool.h"
 #include "../Iex/Iex.h"
-#include <list>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
+//-----------------------------------------------------------------------------
+//
+//	Scheduling
+//
+//	Every worker thread owns a work-stealing deque (Chase and Lev,
+//	"Dynamic Circular Work-Stealing Deque", with the memory orderings
+//	of Le et al., "Correct and Efficient Work-Stealing for Weak Memory
+//	Models").  The owner pushes and pops at the bottom end without
+//	locking, idle workers steal from the top end with a single CAS.
+//
+//	Threads that are not workers of the pool cannot use the owner end
+//	of a deque.  Their tasks go to a lock-free inbox of one of the
+//	workers, picked round robin.  An inbox is a Treiber stack that is
+//	emptied in one atomic exchange, so any worker may drain it.  A
+//	worker that drains an inbox runs the oldest task itself and moves
+//	the rest to its deque, where other workers can steal them.
+//
+//	Workers that find no work anywhere spin for a short while and
+//	then park on a condition variable.  Submitters only touch the
+//	condition variable when a worker is parked.
+//
+//-----------------------------------------------------------------------------
+
 namespace IlmThread {
 namespace {
 
-class WorkerThread: public Thread
+class WorkerThread;
+
+
+//
+// Work-stealing deque of tasks.  push() and pop() may only be called
+// by the owning worker, steal() by any thread.
+//
+
+class TaskDeque
 {
   public:
 
-    WorkerThread (ThreadPool::Data* data);
+     TaskDeque ();
+    ~TaskDeque ();
+
+    void	push (Task* task);
+    Task *	pop ();
+    Task *	steal ();
+    bool	empty () const;
 
-    virtual void	run ();
-    
   private:
 
-    ThreadPool::Data *	_data;
+    struct Array
+    {
+	Array (long long size):
+	    size (size), mask (size - 1), slots (new atomic<Task*>[size]) {}
+
+	~Array () {delete [] slots;}
+
+	Task * get (long long i) const
+	{
+	    return slots[i & mask].load (memory_order_relaxed);
+	}
+
+	void put (long long i, Task* task)
+	{
+	    slots[i & mask].store (task, memory_order_relaxed);
+	}
+
+	long long		size;
+	long long		mask;
+	atomic<Task*> *		slots;
+    };
+
+    Array *	grow (Array* a, long long bottom, long long top);
+
+    atomic<long long>	_top;
+    atomic<long long>	_bottom;
+    atomic<Array*>	_array;
+    vector<Array*>	_retired;	// old arrays, a thief may still
+					// read from them
+};
+
+
+TaskDeque::TaskDeque (): _top (0), _bottom (0), _array (new Array (256))
+{
+    // empty
+}
+
+
+TaskDeque::~TaskDeque ()
+{
+    delete _array.load (memory_order_relaxed);
+
+    for (size_t i = 0; i < _retired.size(); ++i)
+	delete _retired[i];
+}
+
+
+TaskDeque::Array *
+TaskDeque::grow (Array* a, long long bottom, long long top)
+{
+    Array* b = new Array (a->size * 2);
+
+    for (long long i = top; i < bottom; ++i)
+	b->put (i, a->get (i));
+
+    _retired.push_back (a);
+    return b;
+}
+
+
+void
+TaskDeque::push (Task* task)
+{
+    long long b = _bottom.load (memory_order_relaxed);
+    long long t = _top.load (memory_order_acquire);
+    Array* a = _array.load (memory_order_relaxed);
+
+    if (b - t > a->size - 1)
+    {
+	a = grow (a, b, t);
+	_array.store (a, memory_order_release);
+    }
+
+    a->put (b, task);
+    atomic_thread_fence (memory_order_release);
+    _bottom.store (b + 1, memory_order_relaxed);
+}
+
+
+Task *
+TaskDeque::pop ()
+{
+    long long b = _bottom.load (memory_order_relaxed) - 1;
+    Array* a = _array.load (memory_order_relaxed);
+    _bottom.store (b, memory_order_relaxed);
+    atomic_thread_fence (memory_order_seq_cst);
+    long long t = _top.load (memory_order_relaxed);
+
+    Task* task = 0;
+
+    if (t <= b)
+    {
+	task = a->get (b);
+
+	if (t == b)
+	{
+	    //
+	    // Last task, race against thieves for it
+	    //
+
+	    if (!_top.compare_exchange_strong (t, t + 1,
+					       memory_order_seq_cst,
+					       memory_order_relaxed))
+	    {
+		task = 0;
+	    }
+
+	    _bottom.store (b + 1, memory_order_relaxed);
+	}
+    }
+    else
+    {
+	_bottom.store (b + 1, memory_order_relaxed);
+    }
+
+    return task;
+}
+
+
+Task *
+TaskDeque::steal ()
+{
+    long long t = _top.load (memory_order_acquire);
+    atomic_thread_fence (memory_order_seq_cst);
+    long long b = _bottom.load (memory_order_acquire);
+
+    if (t >= b)
+	return 0;
+
+    Array* a = _array.load (memory_order_acquire);
+    Task* task = a->get (t);
+
+    if (!_top.compare_exchange_strong (t, t + 1,
+				       memory_order_seq_cst,
+				       memory_order_relaxed))
+    {
+	return 0;
+    }
+
+    return task;
+}
+
+
+bool
+TaskDeque::empty () const
+{
+    long long t = _top.load (memory_order_acquire);
+    long long b = _bottom.load (memory_order_acquire);
+    return t >= b;
+}
+
+
+//
+// Lock-free multi-producer inbox.  Tasks come out in submission order.
+//
+
+class TaskInbox
+{
+  public:
+
+     TaskInbox (): _head (0) {}
+
+    void	push (Task* task);
+    bool	empty () const {return _head.load (memory_order_acquire) == 0;}
+
+    //
+    // Take all tasks.  Returns the oldest task, the remaining tasks
+    // are appended to rest in submission order.
+    //
+
+    Task *	takeAll (vector<Task*>& rest);
+
+  private:
+
+    struct Node
+    {
+	Task *	task;
+	Node *	next;
+    };
+
+    atomic<Node*>	_head;
+};
+
+
+void
+TaskInbox::push (Task* task)
+{
+    Node* n = new Node;
+    n->task = task;
+    n->next = _head.load (memory_order_relaxed);
+
+    while (!_head.compare_exchange_weak (n->next, n,
+					 memory_order_release,
+					 memory_order_relaxed))
+    {
+	// n->next was updated, retry
+    }
+}
+
+
+Task *
+TaskInbox::takeAll (vector<Task*>& rest)
+{
+    Node* n = _head.exchange (0, memory_order_acquire);
+
+    if (n == 0)
+	return 0;
+
+    //
+    // The stack holds the newest task first
+    //
+
+    size_t first = rest.size();
+
+    while (n)
+    {
+	Node* next = n->next;
+	rest.push_back (n->task);
+	delete n;
+	n = next;
+    }
+
+    Task* oldest = rest.back();
+    rest.pop_back();
+
+    for (size_t i = first, j = rest.size(); i + 1 < j; ++i, --j)
+	swap (rest[i], rest[j - 1]);
+
+    return oldest;
+}
+
+
+//
+// Per worker queues and counters.  Counters are only written by the
+// owning worker.
+//
+
+struct WorkerSlot
+{
+    WorkerSlot (size_t index = 0):
+	index (index), executed (0), stolen (0), parked (0) {}
+
+    size_t			index;		// position in ThreadPool::Data::slots
+    TaskDeque			deque;
+    TaskInbox			inbox;
+
+    atomic<unsigned long long>	executed;
+    atomic<unsigned long long>	stolen;
+    atomic<unsigned long long>	parked;
+
+    void count (atomic<unsigned long long>& c)
+    {
+	c.store (c.load (memory_order_relaxed) + 1, memory_order_relaxed);
+    }
 };
 
 } //namespace
@@ -74,8 +366,8 @@ struct TaskGroup::Data
     void	addTask () ;
     void	removeTask ();
     
-    Semaphore	isEmpty;	// used to signal that the taskgroup is empty
-    int		numPending;	// number of pending tasks to still execute
+    Semaphore		isEmpty;	// used to signal that the taskgroup is empty
+    atomic<int>		numPending;	// number of pending tasks to still execute
 };
 
 
@@ -85,25 +377,68 @@ struct ThreadPool::Data
     ~Data();
     
     void	finish ();
-    bool	stopped () const;
-    void	stop ();
+    void	start (int count);
+
+    void	submit (Task* task);
+    void	wake (bool all);
+    bool	hasWork () const;
+    Task *	findTask (WorkerSlot* self, vector<Task*>& batch);
+
+    static void	runTask (Task* task);
 
-    Semaphore taskSemaphore;        // threads wait on this for ready tasks
-    Mutex taskMutex;                // mutual exclusion for the tasks list
-    list<Task*> tasks;              // the list of tasks to execute
-    size_t numTasks;                // fast access to list size
-                                    //   (list::size() can be O(n))
+    vector<WorkerSlot*> slots;      // one slot per worker thread
+    atomic<unsigned> nextSlot;      // round robin inbox for submitters
 
     Semaphore threadSemaphore;      // signaled when a thread starts executing
     Mutex threadMutex;              // mutual exclusion for threads list
-    list<WorkerThread*> threads;    // the list of all threads
-    size_t numThreads;              // fast access to list size
+    vector<WorkerThread*> threads;  // the list of all threads
+    atomic<int> numThreads;         // number of running worker threads
+
+    atomic<int> submitters;         // threads currently inside addTask
+    atomic<bool> resizing;          // set while threads are being replaced
+
+    mutex sleepMutex;               // parking of idle workers
+    condition_variable sleepCond;
+    atomic<int> sleeping;           // number of parked workers
+    atomic<bool> stopping;          // flag indicating whether to stop threads
+
+    WorkerSlot retired;             // counters of workers that were stopped
+};
+
+
+namespace {
+
+//
+// Worker thread of a pool and the pool it is running for.
+//
+
+class WorkerThread: public Thread
+{
+  public:
+
+    WorkerThread (ThreadPool::Data* data, WorkerSlot* slot);
+
+    virtual void	run ();
     
-    bool stopping;                  // flag indicating whether to stop threads
-    Mutex stopMutex;                // mutual exclusion for stopping flag
+    ThreadPool::Data *	data () const {return _data;}
+    WorkerSlot *	slot () const {return _slot;}
+
+  private:
+
+    ThreadPool::Data *	_data;
+    WorkerSlot *	_slot;
 };
 
 
+//
+// The worker running on the current thread, if any.
+//
+
+thread_local WorkerThread* currentWorker = 0;
+
+} //namespace
+
+
 //
 // The global thread pool
 //
@@ -115,8 +450,9 @@ ThreadPool gThreadPool (0);
 // class WorkerThread
 //
 
-WorkerThread::WorkerThread (ThreadPool::Data* data):
-    _data (data)
+WorkerThread::WorkerThread (ThreadPool::Data* data, WorkerSlot* slot):
+    _data (data),
+    _slot (slot)
 {
     start();
 }
@@ -131,41 +467,59 @@ WorkerThread::run ()
 
     _data->threadSemaphore.post();
 
+    currentWorker = this;
+    vector<Task*> batch;
+
     while (true)
     {
 	//
-        // Wait for a task to become available
+	// Look for work, spinning a little before parking
 	//
 
-        _data->taskSemaphore.wait();
+	Task* task = 0;
 
-        {
-            Lock taskLock (_data->taskMutex);
-    
-	    //
-            // If there is a task pending, pop off the next task in the FIFO
-	    //
+	for (int spin = 0; spin < 64 && task == 0; ++spin)
+	{
+	    task = _data->findTask (_slot, batch);
 
-            if (_data->numTasks > 0)
-            {
-                Task* task = _data->tasks.front();
-		TaskGroup* taskGroup = task->group();
-                _data->tasks.pop_front();
-                _data->numTasks--;
-
-                taskLock.release();
-                task->execute();
-                taskLock.acquire();
-
-                delete task;
-                taskGroup->_data->removeTask();
-            }
-            else if (_data->stopped())
-	    {
-                break;
-	    }
-        }
+	    if (task == 0)
+		this_thread::yield();
+	}
+
+	if (task)
+	{
+	    ThreadPool::Data::runTask (task);
+	    _slot->count (_slot->executed);
+	    continue;
+	}
+
+	unique_lock<mutex> lock (_data->sleepMutex);
+	_data->sleeping.fetch_add (1);
+	atomic_thread_fence (memory_order_seq_cst);
+
+	//
+	// Re-check under the lock: a submitter that pushed before it
+	// saw this worker counted as sleeping must be noticed here.
+	//
+
+	if (_data->hasWork())
+	{
+	    _data->sleeping.fetch_sub (1);
+	    continue;
+	}
+
+	if (_data->stopping.load())
+	{
+	    _data->sleeping.fetch_sub (1);
+	    break;
+	}
+
+	_slot->count (_slot->parked);
+	_data->sleepCond.wait (lock);
+	_data->sleeping.fetch_sub (1);
     }
+
+    currentWorker = 0;
 }
 
 
@@ -195,12 +549,12 @@ void
 TaskGroup::Data::addTask () 
 {
     //
-    // Any access to the taskgroup is protected by a mutex that is
-    // held by the threadpool.  Therefore it is safe to access
-    // numPending before we wait on the semaphore.
+    // The first pending task takes the semaphore, the last finished
+    // task gives it back.  If the task finishes before we get to
+    // wait() the semaphore count is 2 for a moment, which is fine.
     //
 
-    if (numPending++ == 0)
+    if (numPending.fetch_add (1) == 0)
 	isEmpty.wait ();
 }
 
@@ -208,7 +562,7 @@ TaskGroup::Data::addTask ()
 void
 TaskGroup::Data::removeTask ()
 {
-    if (--numPending == 0)
+    if (numPending.fetch_sub (1) == 1)
 	isEmpty.post ();
 }
     
@@ -217,7 +571,13 @@ TaskGroup::Data::removeTask ()
 // struct ThreadPool::Data
 //
 
-ThreadPool::Data::Data (): numTasks (0), numThreads (0), stopping (false)
+ThreadPool::Data::Data ():
+    nextSlot (0),
+    numThreads (0),
+    submitters (0),
+    resizing (false),
+    sleeping (0),
+    stopping (false)
 {
     // empty
 }
@@ -231,12 +591,27 @@ ThreadPool::Data::~Data()
 
 
 void
-ThreadPool::Data::finish ()
+ThreadPool::Data::start (int count)
 {
-    stop();
-
     //
-    // Signal enough times to allow all threads to stop.
+    // Called with threadMutex held and no worker threads running
+    //
+
+    stopping = false;
+
+    for (int i = 0; i < count; i++)
+	slots.push_back (new WorkerSlot (i));
+
+    for (int i = 0; i < count; i++)
+	threads.push_back (new WorkerThread (this, slots[i]));
+
+    numThreads = count;
+}
+
+
+void
+ThreadPool::Data::finish ()
+{
     //
     // Wait until all threads have started their run functions.
     // If we do not wait before we destroy the threads then it's
@@ -247,46 +622,164 @@ ThreadPool::Data::finish ()
     // an error like: "pure virtual method called"
     //
 
-    for (int i = 0; i < numThreads; i++)
-    {
-	taskSemaphore.post();
+    for (size_t i = 0; i < threads.size(); i++)
 	threadSemaphore.wait();
+
+    //
+    // Workers run all queued tasks before they see the stop flag
+    //
+
+    {
+	lock_guard<mutex> lock (sleepMutex);
+	stopping = true;
     }
 
+    sleepCond.notify_all();
+
     //
     // Join all the threads
     //
 
-    for (list<WorkerThread*>::iterator i = threads.begin();
-	 i != threads.end();
-	 ++i)
+    for (size_t i = 0; i < threads.size(); i++)
+	delete threads[i];
+
+    for (size_t i = 0; i < slots.size(); i++)
     {
-	delete (*i);
+	WorkerSlot* s = slots[i];
+
+	retired.executed += s->executed.load();
+	retired.stolen += s->stolen.load();
+	retired.parked += s->parked.load();
+
+	delete s;
     }
 
-    Lock lock1 (taskMutex);
-    Lock lock2 (stopMutex);
     threads.clear();
-    tasks.clear();
+    slots.clear();
     numThreads = 0;
-    numTasks = 0;
     stopping = false;
 }
 
 
-bool
-ThreadPool::Data::stopped () const
+void
+ThreadPool::Data::runTask (Task* task)
+{
+    TaskGroup* taskGroup = task->group();
+
+    task->execute();
+    delete task;
+
+    taskGroup->_data->removeTask();
+}
+
+
+void
+ThreadPool::Data::submit (Task* task)
 {
-    Lock lock (stopMutex);
-    return stopping;
+    WorkerThread* w = currentWorker;
+
+    if (w && w->data() == this)
+    {
+	//
+	// Task spawned by one of our own workers, keep it local
+	//
+
+	w->slot()->deque.push (task);
+    }
+    else
+    {
+	unsigned i = nextSlot.fetch_add (1, memory_order_relaxed);
+	slots[i % slots.size()]->inbox.push (task);
+    }
+
+    //
+    // Pairs with the fence in WorkerThread::run: either the worker
+    // sees the task or we see the worker parked.
+    //
+
+    atomic_thread_fence (memory_order_seq_cst);
+
+    if (sleeping.load() > 0)
+	wake (false);
 }
 
 
 void
-ThreadPool::Data::stop ()
+ThreadPool::Data::wake (bool all)
+{
+    lock_guard<mutex> lock (sleepMutex);
+
+    if (all)
+	sleepCond.notify_all();
+    else
+	sleepCond.notify_one();
+}
+
+
+bool
+ThreadPool::Data::hasWork () const
+{
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+	if (!slots[i]->inbox.empty() || !slots[i]->deque.empty())
+	    return true;
+    }
+
+    return false;
+}
+
+
+Task *
+ThreadPool::Data::findTask (WorkerSlot* self, vector<Task*>& batch)
 {
-    Lock lock (stopMutex);
-    stopping = true;
+    //
+    // Own deque first, then our inbox, then steal from the others
+    // starting at our right neighbour.
+    //
+
+    Task* task = self->deque.pop();
+
+    if (task)
+	return task;
+
+    size_t n = slots.size();
+    size_t me = self->index;
+
+    for (size_t k = 0; k < n; ++k)
+    {
+	WorkerSlot* victim = slots[(me + k) % n];
+
+	batch.clear();
+	task = victim->inbox.takeAll (batch);
+
+	if (task)
+	{
+	    //
+	    // Push so that pop() returns the rest in submission order
+	    //
+
+	    for (size_t i = batch.size(); i > 0; --i)
+		self->deque.push (batch[i - 1]);
+
+	    if (!batch.empty() && sleeping.load() > 0)
+		wake (batch.size() > 1);
+
+	    return task;
+	}
+
+	if (k == 0)
+	    continue;
+
+	task = victim->deque.steal();
+
+	if (task)
+	{
+	    self->count (self->stolen);
+	    return task;
+	}
+    }
+
+    return 0;
 }
 
 
@@ -346,8 +839,7 @@ ThreadPool::~ThreadPool ()
 int
 ThreadPool::numThreads () const
 {
-    Lock lock (_data->threadMutex);
-    return _data->numThreads;
+    return _data->numThreads.load();
 }
 
 
@@ -364,37 +856,28 @@ ThreadPool::setNumThreads (int count)
 
     Lock lock (_data->threadMutex);
 
-    if (count > _data->numThreads)
-    {
-	//
-        // Add more threads
-	//
+    if (count == _data->numThreads.load())
+	return;
 
-        while (_data->numThreads < count)
-        {
-            _data->threads.push_back (new WorkerThread (_data));
-            _data->numThreads++;
-        }
-    }
-    else if (count < _data->numThreads)
-    {
-	//
-	// Wait until all existing threads are finished processing,
-	// then delete all threads.
-	//
+    //
+    // Keep addTask out while the workers and their queues are
+    // replaced.  Submitters that already got in finish first.
+    //
 
-        _data->finish ();
+    _data->resizing = true;
 
-	//
-        // Add in new threads
-	//
+    while (_data->submitters.load() > 0)
+	this_thread::yield();
 
-        while (_data->numThreads < count)
-        {
-            _data->threads.push_back (new WorkerThread (_data));
-            _data->numThreads++;
-        }
-    }
+    //
+    // Wait until all existing threads are finished processing,
+    // then delete all threads and add in new ones.
+    //
+
+    _data->finish ();
+    _data->start (count);
+
+    _data->resizing = false;
 }
 
 
@@ -402,40 +885,54 @@ void
 ThreadPool::addTask (Task* task) 
 {
     //
-    // Lock the threads, needed to access numThreads
+    // Register as submitter, or wait for a resize to complete
     //
 
-    Lock lock (_data->threadMutex);
+    while (true)
+    {
+	_data->submitters.fetch_add (1);
+
+	if (!_data->resizing.load())
+	    break;
+
+	_data->submitters.fetch_sub (1);
+	Lock lock (_data->threadMutex);
+    }
 
-    if (_data->numThreads == 0)
+    if (_data->numThreads.load() == 0)
     {
+	_data->submitters.fetch_sub (1);
+
         task->execute ();
         delete task;
     }
     else
     {
-	//
-        // Get exclusive access to the tasks queue
-	//
+	task->group()->_data->addTask();
+	_data->submit (task);
+	_data->submitters.fetch_sub (1);
+    }
+}
 
-        {
-            Lock taskLock (_data->taskMutex);
 
-	    //
-            // Push the new task into the FIFO
-	    //
+ThreadPool::Stats
+ThreadPool::stats () const
+{
+    Lock lock (_data->threadMutex);
 
-            _data->tasks.push_back (task);
-            _data->numTasks++;
-            task->group()->_data->addTask();
-        }
-        
-	//
-        // Signal that we have a new task to process
-	//
+    Stats s;
+    s.executed = _data->retired.executed.load();
+    s.stolen = _data->retired.stolen.load();
+    s.parked = _data->retired.parked.load();
 
-        _data->taskSemaphore.post ();
+    for (size_t i = 0; i < _data->slots.size(); i++)
+    {
+	s.executed += _data->slots[i]->executed.load();
+	s.stolen += _data->slots[i]->stolen.load();
+	s.parked += _data->slots[i]->parked.load();
     }
+
+    return s;
 }
 
 
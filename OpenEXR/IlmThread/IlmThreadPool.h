@@ -101,11 +101,28 @@ class ThreadPool
     //------------------------------------------------------------
     // Add a task for processing.  The ThreadPool can handle any
     // number of tasks regardless of the number of worker threads.
-    // The tasks are first added onto a queue, and are executed
-    // by threads as they become available, in FIFO order.
+    // The tasks are first added onto a per-thread queue, and are
+    // executed by threads as they become available, roughly in
+    // FIFO order.  Idle threads steal tasks from busy ones.
     //------------------------------------------------------------
 
     void addTask (Task* task);
+
+
+    //------------------------------------------------------------
+    // Counters for measuring the pool: tasks executed by worker
+    // threads, tasks a worker stole from another worker's queue,
+    // and how often a worker found no work and went to sleep.
+    //------------------------------------------------------------
+
+    struct Stats
+    {
+	unsigned long long	executed;
+	unsigned long long	stolen;
+	unsigned long long	parked;
+    };
+
+    Stats	stats () const;
     
 
     //-------------------------------------------
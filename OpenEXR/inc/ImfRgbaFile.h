@@ -273,6 +273,7 @@ class RgbaInputFile
 
     void			readPixels (int scanLine1, int scanLine2);
     void			readPixels (int scanLine);
+    void			readAllPixels ();
 
 
     //--------------------------
@@ -45,7 +45,7 @@
 
 // defining NOMINMAX to prevent problems with std::min/std::max
 // and std::numeric_limits<type>::min()/std::numeric_limits<type>::max()
-// when boost include windows.h
+// when windows.h is included
 #ifdef _MSC_VER
 # define WIN32_LEAN_AND_MEAN
 # define VC_EXTRALEAN
@@ -53,47 +53,19 @@
 #   define NOMINMAX
 # endif
 #endif
- 
-#include <boost/version.hpp>
-#if defined(__GNUC__) && (BOOST_VERSION == 104500)
-// gcc reports errors inside some of the boost headers with boost 1.45
-// See: https://svn.boost.org/trac/boost/ticket/4818
-#pragma GCC diagnostic ignored "-Wunused-variable"
-#endif
-
-#include <boost/thread.hpp>
-#include <boost/thread/tss.hpp>
-#include <boost/version.hpp>
 
-#if defined(__GNUC__) && (BOOST_VERSION == 104500)
-// can't restore via push/pop in all versions of gcc (warning push/pop implemented for 4.6+ only)
-#pragma GCC diagnostic error "-Wunused-variable"
-#endif
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
-#ifndef USE_TBB
-#  define USE_TBB 0
-#endif
 
-// Include files we need for atomic counters.
-// Some day, we hope this is all replaced by use of std::atomic<>.
-#if USE_TBB
-#  include <tbb/atomic.h>
-#  include <tbb/spin_mutex.h>
-#  define USE_TBB_ATOMIC 1
-#  define USE_TBB_SPINLOCK 1
-#else
-#  define USE_TBB_ATOMIC 0
-#  define USE_TBB_SPINLOCK 0
-#endif
-
-
-#if defined(_MSC_VER) && !USE_TBB
+#if defined(_MSC_VER)
 #  include <windows.h>
 #  include <winbase.h>
 #  pragma intrinsic (_InterlockedExchangeAdd)
 #  pragma intrinsic (_InterlockedCompareExchange)
 #  pragma intrinsic (_InterlockedCompareExchange64)
-#  pragma intrinsic (_ReadWriteBarrier)
 #  if defined(_WIN64)
 #    pragma intrinsic(_InterlockedExchangeAdd64)
 #  endif
@@ -203,13 +175,141 @@ typedef null_lock<recursive_mutex> recursive_lock_guard;
 
 #else
 
-// Fairly modern Boost has all the mutex and lock types we need.
+// The standard library has all the mutex and lock types we need.
+
+typedef std::mutex mutex;
+typedef std::recursive_mutex recursive_mutex;
+typedef std::lock_guard< std::mutex > lock_guard;
+typedef std::lock_guard< std::recursive_mutex > recursive_lock_guard;
+
+
+namespace pvt {
 
-typedef boost::mutex mutex;
-typedef boost::recursive_mutex recursive_mutex;
-typedef boost::lock_guard< boost::mutex > lock_guard;
-typedef boost::lock_guard< boost::recursive_mutex > recursive_lock_guard;
-using boost::thread_specific_ptr;
+/// The values of all thread_specific_ptr objects for one thread, keyed
+/// by the unique key of each thread_specific_ptr.  Values that are still
+/// set when the thread exits are cleaned up by the table's destructor.
+class thread_specific_table {
+public:
+    typedef void (*cleanup_t)(void *ptr, void (*dest)());
+
+    struct entry {
+        void *ptr;
+        cleanup_t cleanup;
+        void (*dest)();
+    };
+
+    ~thread_specific_table () {
+        // Cleanup functions may themselves reset thread_specific_ptr
+        // values, so take the entries out one at a time.
+        while (! m_entries.empty()) {
+            std::unordered_map<unsigned long long, entry>::iterator i = m_entries.begin();
+            entry e = i->second;
+            m_entries.erase (i);
+            e.cleanup (e.ptr, e.dest);
+        }
+    }
+
+    std::unordered_map<unsigned long long, entry> m_entries;
+};
+
+
+/// The table of the calling thread.
+inline thread_specific_table &
+this_thread_table ()
+{
+    static thread_local thread_specific_table table;
+    return table;
+}
+
+
+/// A key no other thread_specific_ptr has used.  Keys are never reused,
+/// so a new thread_specific_ptr can never pick up a stale value that
+/// another thread set through a destroyed one at the same address.
+inline unsigned long long
+new_thread_specific_key ()
+{
+    static std::atomic<unsigned long long> next (1);
+    return next.fetch_add (1, std::memory_order_relaxed);
+}
+
+}  // namespace pvt
+
+
+/// Pointer with a separate value for each thread, like
+/// boost::thread_specific_ptr.  A thread's value is cleaned up -- passed
+/// to the destructor function given to the constructor, or deleted if
+/// there is none -- when it is replaced by reset(), when the thread exits,
+/// or, for the calling thread only, when the thread_specific_ptr is
+/// destroyed.
+template<typename T>
+class thread_specific_ptr {
+public:
+    typedef void (*destructor_t)(T *);
+
+    thread_specific_ptr (destructor_t dest=NULL)
+        : m_key(pvt::new_thread_specific_key()), m_dest(dest) { }
+
+    ~thread_specific_ptr () { reset (NULL); }
+
+    /// The calling thread's value, or NULL if it has none.
+    T * get () const {
+        const std::unordered_map<unsigned long long, pvt::thread_specific_table::entry> &
+            entries (pvt::this_thread_table().m_entries);
+        std::unordered_map<unsigned long long, pvt::thread_specific_table::entry>::const_iterator
+            i = entries.find (m_key);
+        return i == entries.end() ? NULL : (T *) i->second.ptr;
+    }
+
+    T * operator-> () const { return get(); }
+
+    T & operator* () const { return *get(); }
+
+    /// Give up the calling thread's value without cleaning it up, and
+    /// return it.
+    T * release () {
+        std::unordered_map<unsigned long long, pvt::thread_specific_table::entry> &
+            entries (pvt::this_thread_table().m_entries);
+        std::unordered_map<unsigned long long, pvt::thread_specific_table::entry>::iterator
+            i = entries.find (m_key);
+        if (i == entries.end())
+            return NULL;
+        T *ptr = (T *) i->second.ptr;
+        entries.erase (i);
+        return ptr;
+    }
+
+    /// Replace the calling thread's value, cleaning up the old one.
+    void reset (T *newptr=NULL) {
+        T *old = release ();
+        if (newptr) {
+            pvt::thread_specific_table::entry e;
+            e.ptr = newptr;
+            e.cleanup = &cleanup;
+            e.dest = reinterpret_cast<void (*)()> (m_dest);
+            pvt::this_thread_table().m_entries[m_key] = e;
+        }
+        if (old && old != newptr)
+            cleanup (old, reinterpret_cast<void (*)()> (m_dest));
+    }
+
+private:
+    // The table outlives the thread_specific_ptr when other threads
+    // exit after it is destroyed, so the cleanup must not use *this.
+    static void cleanup (void *ptr, void (*dest)()) {
+        destructor_t d = reinterpret_cast<destructor_t> (dest);
+        if (d)
+            (*d) ((T *) ptr);
+        else
+            delete (T *) ptr;
+    }
+
+    unsigned long long m_key;
+    destructor_t m_dest;
+
+    // Disallow copying by making private and unimplemented.
+    thread_specific_ptr (const thread_specific_ptr &);
+    thread_specific_ptr & operator= (const thread_specific_ptr &);
+};
 
 #endif
 
@@ -217,6 +317,9 @@ using boost::thread_specific_ptr;
 
 /// Atomic version of:  r = *at, *at += x, return r
 /// For each of several architectures.
+///
+/// These work on plain integers, for code that predates atomic<>; new
+/// code should use atomic<> instead.
 inline int
 atomic_exchange_and_add (volatile int *at, int x)
 {
@@ -224,9 +327,6 @@ atomic_exchange_and_add (volatile int *at, int x)
     int r = *at;  *at += x;  return r;
 #elif defined(USE_GCC_ATOMICS)
     return __sync_fetch_and_add ((int *)at, x);
-#elif USE_TBB
-    atomic<int> *a = (atomic<int> *)at;
-    return a->fetch_and_add (x);
 #elif defined(_MSC_VER)
     // Windows
     return _InterlockedExchangeAdd ((volatile LONG *)at, x);
@@ -244,9 +344,6 @@ atomic_exchange_and_add (volatile long long *at, long long x)
     long long r = *at;  *at += x;  return r;
 #elif defined(USE_GCC_ATOMICS)
     return __sync_fetch_and_add (at, x);
-#elif USE_TBB
-    atomic<long long> *a = (atomic<long long> *)at;
-    return a->fetch_and_add (x);
 #elif defined(_MSC_VER)
     // Windows
 #  if defined(_WIN64)
@@ -278,9 +375,6 @@ atomic_compare_and_exchange (volatile int *at, int compareval, int newval)
     }
 #elif defined(USE_GCC_ATOMICS)
     return __sync_bool_compare_and_swap (at, compareval, newval);
-#elif USE_TBB
-    atomic<int> *a = (atomic<int> *)at;
-    return a->compare_and_swap (newval, compareval) == newval;
 #elif defined(_MSC_VER)
     return (_InterlockedCompareExchange ((volatile LONG *)at, newval, compareval) == compareval);
 #else
@@ -301,9 +395,6 @@ atomic_compare_and_exchange (volatile long long *at, long long compareval, long
     }
 #elif defined(USE_GCC_ATOMICS)
     return __sync_bool_compare_and_swap (at, compareval, newval);
-#elif USE_TBB
-    atomic<long long> *a = (atomic<long long> *)at;
-    return a->compare_and_swap (newval, compareval) == newval;
 #elif defined(_MSC_VER)
     return (_InterlockedCompareExchange64 ((volatile LONGLONG *)at, newval, compareval) == compareval);
 #else
@@ -318,13 +409,7 @@ atomic_compare_and_exchange (volatile long long *at, long long compareval, long
 inline void
 yield ()
 {
-#if defined(__GNUC__)
-    sched_yield ();
-#elif defined(_MSC_VER)
-    SwitchToThread ();
-#else
-#   error No yield on this platform.
-#endif
+    std::this_thread::yield ();
 }
 
 
@@ -341,9 +426,6 @@ pause (int delay)
     for (int i = 0; i < delay; ++i)
         __asm__ __volatile__("NOP;");
 
-#elif USE_TBB
-    __TBB_Pause(delay);
-
 #elif defined(_MSC_VER)
     for (int i = 0; i < delay; ++i) {
 #if defined (_WIN64)
@@ -381,14 +463,14 @@ private:
 
 
 
-#if USE_TBB_ATOMIC
-using tbb::atomic;
-#else
-// If we're not using TBB's atomic, we need to define our own atomic<>.
-
-
 /// Atomic integer.  Increment, decrement, add, and subtract in a
 /// totally thread-safe manner.
+///
+/// Reads are acquire loads and assignments are release stores, which
+/// compile to plain moves on x86.  Read-modify-write operations are
+/// acq_rel, enough for reference counts and the lock-free handoffs
+/// this class is used for; code that needs sequential consistency
+/// between different atomics must use std::atomic directly.
 template<class T>
 class atomic {
 public:
@@ -400,54 +482,51 @@ public:
 
     /// Retrieve value
     ///
-    T operator() () const { return atomic_exchange_and_add (&m_val, 0); }
+    T operator() () const { return m_val.load (std::memory_order_acquire); }
 
     /// Retrieve value
     ///
-    operator T() const { return atomic_exchange_and_add (&m_val, 0); }
+    operator T() const { return m_val.load (std::memory_order_acquire); }
 
     /// Fast retrieval of value, no interchange, don't care about memory
     /// fences.
-    T fast_value () const { return m_val; }
+    T fast_value () const { return m_val.load (std::memory_order_relaxed); }
 
     /// Assign new value.
     ///
     T operator= (T x) {
-        //incorrect? return (m_val = x);
-        while (1) {
-            T result = m_val;
-            if (atomic_compare_and_exchange (&m_val, result, x))
-                break;
-        }
+        m_val.store (x, std::memory_order_release);
         return x;
     }
 
     /// Pre-increment:  ++foo
     ///
-    T operator++ () { return atomic_exchange_and_add (&m_val, 1) + 1; }
+    T operator++ () { return m_val.fetch_add (1, std::memory_order_acq_rel) + 1; }
 
     /// Post-increment:  foo++
     ///
-    T operator++ (int) {  return atomic_exchange_and_add (&m_val, 1); }
+    T operator++ (int) {  return m_val.fetch_add (1, std::memory_order_acq_rel); }
 
     /// Pre-decrement:  --foo
     ///
-    T operator-- () {  return atomic_exchange_and_add (&m_val, -1) - 1; }
+    T operator-- () {  return m_val.fetch_sub (1, std::memory_order_acq_rel) - 1; }
 
     /// Post-decrement:  foo--
     ///
-    T operator-- (int) {  return atomic_exchange_and_add (&m_val, -1); }
+    T operator-- (int) {  return m_val.fetch_sub (1, std::memory_order_acq_rel); }
 
     /// Add to the value, return the new result
     ///
-    T operator+= (T x) { return atomic_exchange_and_add (&m_val, x) + x; }
+    T operator+= (T x) { return m_val.fetch_add (x, std::memory_order_acq_rel) + x; }
 
     /// Subtract from the value, return the new result
     ///
-    T operator-= (T x) { return atomic_exchange_and_add (&m_val, -x) - x; }
+    T operator-= (T x) { return m_val.fetch_sub (x, std::memory_order_acq_rel) - x; }
 
     bool bool_compare_and_swap (T compareval, T newval) {
-        return atomic_compare_and_exchange (&m_val, compareval, newval);
+        return m_val.compare_exchange_strong (compareval, newval,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire);
     }
 
     T operator= (const atomic &x) {
@@ -457,18 +536,13 @@ public:
     }
 
 private:
-#ifdef __arm__
-    OIIO_ALIGN(8)
-#endif 
-    volatile mutable T m_val;
+    std::atomic<T> m_val;
 
     // Disallow copy construction by making private and unimplemented.
     atomic (atomic const &);
 };
 
 
-#endif /* ! USE_TBB_ATOMIC */
-
 
 #ifdef NOTHREADS
 
@@ -489,22 +563,13 @@ typedef atomic<long long> atomic_ll;
 typedef null_mutex spin_mutex;
 typedef null_lock<spin_mutex> spin_lock;
 
-#elif USE_TBB_SPINLOCK
-
-// Use TBB's spin locks
-typedef tbb::spin_mutex spin_mutex;
-typedef tbb::spin_mutex::scoped_lock spin_lock;
-
-
 #else
 
-// Define our own spin locks.  Do we trust them?
-
 
 /// A spin_mutex is semantically equivalent to a regular mutex, except
 /// for the following:
-///  - A spin_mutex is just 4 bytes, whereas a regular mutex is quite
-///    large (44 bytes for pthread).
+///  - A spin_mutex is just 1 byte, whereas a regular mutex is quite
+///    large (40 bytes for pthread).
 ///  - A spin_mutex is extremely fast to lock and unlock, whereas a regular
 ///    mutex is surprisingly expensive just to acquire a lock.
 ///  - A spin_mutex takes CPU while it waits, so this can be very
@@ -516,7 +581,7 @@ typedef tbb::spin_mutex::scoped_lock spin_lock;
 /// lock for a very short period of time, you may save runtime by using
 /// a spin_mutex, even though it's non-blocking.
 ///
-/// N.B. A spin_mutex is only the size of an int.  To avoid "false
+/// N.B. A spin_mutex is only the size of a bool.  To avoid "false
 /// sharing", be careful not to put two spin_mutex objects on the same
 /// cache line (within 128 bytes of each other), or the two mutexes may
 /// effectively (and wastefully) lock against each other.
@@ -525,13 +590,13 @@ class spin_mutex {
 public:
     /// Default constructor -- initialize to unlocked.
     ///
-    spin_mutex (void) { m_locked = 0; }
+    spin_mutex (void) : m_locked(false) { }
 
     ~spin_mutex (void) { }
 
     /// Copy constructor -- initialize to unlocked.
     ///
-    spin_mutex (const spin_mutex &) { m_locked = 0; }
+    spin_mutex (const spin_mutex &) : m_locked(false) { }
 
     /// Assignment does not do anything, since lockedness should not
     /// transfer.
@@ -545,57 +610,27 @@ public:
         // lots of contention, eventually yield the timeslice.
         atomic_backoff backoff;
 
-        // Try to get ownership of the lock. Though experimentation, we
-        // found that OIIO_UNLIKELY makes this just a bit faster on 
-        // gcc x86/x86_64 systems.
         while (! OIIO_UNLIKELY(try_lock())) {
             do {
                 backoff();
-            } while (m_locked);
+            } while (m_locked.load (std::memory_order_relaxed));
 
-            // The full try_lock() involves a compare_and_swap, which
-            // writes memory, and that will lock the bus.  But a normal
-            // read of m_locked will let us spin until the value
-            // changes, without locking the bus. So it's faster to
-            // check in this manner until the mutex appears to be free.
+            // try_lock() is an exchange, which needs the cache line
+            // exclusively.  Spinning on a plain load keeps the line
+            // shared until the mutex appears to be free.
         }
     }
 
     /// Release the lock that we hold.
     ///
     void unlock () {
-#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
-        // Fastest way to do it is with a store with "release" semantics
-        __asm__ __volatile__("": : :"memory");
-        m_locked = 0;
-        // N.B. GCC gives us an intrinsic that is even better, an atomic
-        // assignment of 0 with "release" barrier semantics:
-        //  __sync_lock_release (&m_locked);
-        // But empirically we found it not as performant as the above.
-#elif defined(_MSC_VER)
-        _ReadWriteBarrier();
-        m_locked = 0;
-#else
-        // Otherwise, just assign zero to the atomic (but that's a full 
-        // memory barrier).
-        *(atomic_int *)&m_locked = 0;
-#endif
+        m_locked.store (false, std::memory_order_release);
     }
 
     /// Try to acquire the lock.  Return true if we have it, false if
     /// somebody else is holding the lock.
     bool try_lock () {
-#if USE_TBB_ATOMIC
-        // TBB's compare_and_swap returns the original value
-        return (*(atomic_int *)&m_locked).compare_and_swap (0, 1) == 0;
-#elif defined(__GNUC__)
-        // GCC gives us an intrinsic that is even better -- an atomic
-        // exchange with "acquire" barrier semantics.
-        return __sync_lock_test_and_set (&m_locked, 1) == 0;
-#else
-        // Our compare_and_swap returns true if it swapped
-        return atomic_compare_and_exchange (&m_locked, 0, 1);
-#endif
+        return ! m_locked.exchange (true, std::memory_order_acquire);
     }
 
     /// Helper class: scoped lock for a spin_mutex -- grabs the lock upon
@@ -612,7 +647,7 @@ public:
     };
 
 private:
-    volatile int m_locked;  ///< Atomic counter is zero if nobody holds the lock
+    std::atomic<bool> m_locked;  ///< True if somebody holds the lock
 };
 
 
@@ -627,17 +662,23 @@ typedef spin_mutex::lock_guard spin_lock;
 /// holders of the lock, presumably because they are modifying whatever
 /// the lock is protecting) and "readers" (non-exclusive, non-modifying
 /// tasks that may access the protectee simultaneously).
+///
+/// The whole state is one atomic word: a writer bit, a "writer pending"
+/// bit and the reader count.  Readers take the lock with a single
+/// compare-and-swap and never touch a shared write lock.  A waiting
+/// writer sets the pending bit, which keeps new readers out so that a
+/// steady stream of readers can't starve it.
 class spin_rw_mutex {
 public:
     /// Default constructor -- initialize to unlocked.
     ///
-    spin_rw_mutex (void) { m_readers = 0; }
+    spin_rw_mutex (void) : m_state(0) { }
 
     ~spin_rw_mutex (void) { }
 
     /// Copy constructor -- initialize to unlocked.
     ///
-    spin_rw_mutex (const spin_rw_mutex &) { m_readers = 0; }
+    spin_rw_mutex (const spin_rw_mutex &) : m_state(0) { }
 
     /// Assignment does not do anything, since lockedness should not
     /// transfer.
@@ -646,37 +687,54 @@ public:
     /// Acquire the reader lock.
     ///
     void read_lock () {
-        // Spin until there are no writers active
-        m_locked.lock();
-        // Register ourself as a reader
-        ++m_readers;
-        // Release the lock, to let other readers work
-        m_locked.unlock();
+        atomic_backoff backoff;
+        int s = m_state.load (std::memory_order_relaxed);
+        while (1) {
+            if (! (s & (WRITER | WRITER_PENDING))) {
+                if (m_state.compare_exchange_weak (s, s + READER,
+                                                   std::memory_order_acquire,
+                                                   std::memory_order_relaxed))
+                    return;
+            } else {
+                backoff();
+                s = m_state.load (std::memory_order_relaxed);
+            }
+        }
     }
 
     /// Release the reader lock.
     ///
     void read_unlock () {
-        --m_readers;  // it's atomic, no need to lock to release
+        m_state.fetch_sub (READER, std::memory_order_release);
     }
 
     /// Acquire the writer lock.
     ///
     void write_lock () {
-        // Make sure no new readers (or writers) can start
-        m_locked.lock();
-        // Spin until the last reader is done, at which point we will be
-        // the sole owners and nobody else (reader or writer) can acquire
-        // the resource until we release it.
-        while (*(volatile int *)&m_readers > 0)
-                ;
+        atomic_backoff backoff;
+        int s = m_state.load (std::memory_order_relaxed);
+        while (1) {
+            if ((s & ~WRITER_PENDING) == 0) {
+                // No readers or writer: take the lock, clearing the
+                // pending bit (other waiting writers set it again).
+                if (m_state.compare_exchange_weak (s, WRITER,
+                                                   std::memory_order_acquire,
+                                                   std::memory_order_relaxed))
+                    return;
+            } else {
+                if (! (s & WRITER_PENDING))
+                    m_state.fetch_or (WRITER_PENDING, std::memory_order_relaxed);
+                backoff();
+                s = m_state.load (std::memory_order_relaxed);
+            }
+        }
     }
 
     /// Release the writer lock.
     ///
     void write_unlock () {
         // Let other readers or writers get the lock
-        m_locked.unlock ();
+        m_state.fetch_and (~WRITER, std::memory_order_release);
     }
 
     /// Helper class: scoped read lock for a spin_rw_mutex -- grabs the
@@ -706,12 +764,9 @@ public:
     };
 
 private:
-    OIIO_CACHE_ALIGN
-    spin_mutex m_locked;   // write lock
-    char pad1_[OIIO_CACHE_LINE_SIZE-sizeof(spin_mutex)];
-    OIIO_CACHE_ALIGN
-    atomic_int m_readers;  // number of readers
-    char pad2_[OIIO_CACHE_LINE_SIZE-sizeof(atomic_int)];
+    enum { WRITER = 1, WRITER_PENDING = 2, READER = 4 };
+
+    std::atomic<int> m_state;  ///< Writer and pending bits, 4 * readers
 };
 
 
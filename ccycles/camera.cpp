@@ -233,6 +233,30 @@ void cycles_camera_set_shuttertime(unsigned int client_id, unsigned int scene_id
 	}
 }
 
+int cycles_camera_set_motion(unsigned int client_id, unsigned int scene_id, unsigned int steps, const float* transforms)
+{
+	CCScene* csce = nullptr;
+	ccl::Scene* sce = nullptr;
+	if (!scene_find(scene_id, &csce, &sce)) return -1;
+	if (steps > 1 && (steps % 2 == 0 || transforms == nullptr)) return -2;
+
+	ccl::Camera* cam = sce->camera;
+	cam->motion.clear();
+	if (steps > 1) {
+		cam->motion.resize(steps);
+		for (unsigned int s = 0; s < steps; s++) {
+			const float* t = transforms + (size_t)s * 12;
+			cam->motion[s] = ccl::make_transform(t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7], t[8], t[9], t[10], t[11]);
+		}
+		cam->matrix = cam->motion[steps / 2];
+	}
+	cam->need_update = true;
+	cam->need_device_update = true;
+
+	logger.logit(client_id, "Setting ", steps, " camera motion steps in scene ", scene_id);
+	return 0;
+}
+
 void cycles_camera_set_fisheye_fov(unsigned int client_id, unsigned int scene_id, float fisheye_fov)
 {
 	CCScene* csce = nullptr;
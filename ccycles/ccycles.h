@@ -256,7 +256,9 @@ CCL_CAPI bool __cdecl cycles_device_advanced_shading(int i);
 /* Query if device is used as display device. */
 CCL_CAPI bool __cdecl cycles_device_display_device(int i);
 
-/* Create or get multi device. Return value is index of multi-device in multi-device vector.*/
+/* Create or get multi device. Return value is index of multi-device in multi-device vector.
+ * Work is split over the sub-devices by Cycles itself and is not balanced by
+ * cycles_session_group_balance, which balances separate sessions instead. */
 CCL_CAPI int __cdecl cycles_create_multidevice(int count, int* idx);
 
 /** Query device type.
@@ -358,6 +360,89 @@ CCL_CAPI void __cdecl cycles_scene_object_set_mesh_light_no_cast_shadow(unsigned
  * \ingroup ccycles_object
  */
 CCL_CAPI void __cdecl cycles_scene_object_set_is_block_instance(unsigned int client, unsigned int scene_id, unsigned int object_id, bool is_block_instance);
+/**
+ * Add count instances of mesh_id to scene_id in one call.
+ *
+ * transforms holds 12 floats per instance, the three rows of the 3x4
+ * matrix as passed to cycles_scene_object_set_matrix. Pass nullptr to give
+ * every instance the identity transform. pass_ids, random_ids and
+ * shader_ids are optional per instance arrays, pass nullptr to keep the
+ * defaults. A shader id of UINT_MAX keeps the mesh shaders for that
+ * instance. So does a shader id that isn't in the scene; that is not an
+ * error, it is only reported through the client logger.
+ *
+ * Instances are block instances: the mesh stays in object space and its
+ * BVH is built once, the scene BVH references it with each instance
+ * transform. Memory grows with the number of unique meshes, not with the
+ * number of instances.
+ *
+ * Returns the object id of the first instance, the others follow
+ * consecutively. Returns UINT_MAX on failure.
+ * \ingroup ccycles_object
+ */
+CCL_CAPI unsigned int __cdecl cycles_scene_add_object_instances(unsigned int client_id, unsigned int scene_id, unsigned int mesh_id, unsigned int count,
+	const float* transforms, const int* pass_ids, const unsigned int* random_ids, const unsigned int* shader_ids);
+/**
+ * Get the number of objects in scene, 0 if the scene wasn't found. Object
+ * ids run from 0 to this count minus one.
+ * \ingroup ccycles_object
+ */
+CCL_CAPI unsigned int __cdecl cycles_scene_object_count(unsigned int client_id, unsigned int scene_id);
+/**
+ * Set transforms of count consecutive objects starting at first_object_id,
+ * 12 floats per object as for cycles_scene_add_object_instances. Nothing
+ * changes if transforms is nullptr or the range isn't in the scene.
+ * \ingroup ccycles_object
+ */
+CCL_CAPI void __cdecl cycles_scene_object_instances_set_matrices(unsigned int client_id, unsigned int scene_id, unsigned int first_object_id, unsigned int count, const float* transforms);
+/**
+ * Set motion transforms of object for motion blur, 12 floats per step as
+ * for cycles_scene_add_object_instances. Steps are spread evenly over the
+ * shutter, the center one also becomes the object transform, so steps has
+ * to be odd. 0 or 1 clears object motion. Motion blur needs to be enabled
+ * with cycles_integrator_set_motion_blur.
+ *
+ * \returns 0 on success, -1 if scene or object wasn't found, -2 for an even
+ * step count.
+ * \ingroup ccycles_object
+ */
+CCL_CAPI int __cdecl cycles_scene_object_set_motion(unsigned int client_id, unsigned int scene_id, unsigned int object_id, unsigned int steps, const float* transforms);
+/**
+ * Set properties of count objects in one call. object_ids lists the objects,
+ * or is nullptr for objects 0 to count-1. Every other array holds one value
+ * per object and may be nullptr to leave that property as is. A shader id of
+ * UINT_MAX keeps the current shader of that object.
+ *
+ * All ids are validated before anything is changed, and objects and light
+ * manager get tagged once for the whole batch instead of once per object.
+ *
+ * \returns number of objects set, -1 if scene wasn't found, -2 on an invalid
+ * object or shader id.
+ * \ingroup ccycles_object
+ */
+CCL_CAPI int __cdecl cycles_scene_objects_set_properties(unsigned int client_id, unsigned int scene_id, unsigned int count, const unsigned int* object_ids,
+	const unsigned int* visibility, const unsigned int* shader_ids, const int* pass_ids, const unsigned int* random_ids,
+	const bool* is_shadowcatcher, const bool* mesh_light_no_cast_shadow, const bool* is_block_instance);
+/**
+ * Apply the object state of the next animation frame to a scene. For each
+ * of count objects a transform (12 floats) and a shader id are given, object_ids
+ * lists the objects they are for, or nullptr for objects 0 to count-1.
+ * transforms and shader_ids may be nullptr, a shader id of UINT_MAX keeps
+ * the current shader.
+ *
+ * State is compared against the previous frame and only objects that actually
+ * changed get tagged. Meshes of objects that are kept in object space are
+ * not re-uploaded and their BVHs are reused, only the top-level BVH gets
+ * rebuilt. A mesh a static BVH baked into world space is moved back to
+ * object space when its object moves, and gets re-uploaded and re-baked
+ * with the new transform. For animation a dynamic BVH or block instances
+ * avoid that cost. Follow with cycles_session_reset_frame.
+ *
+ * \returns number of objects that changed, -1 if scene wasn't found.
+ * \ingroup ccycles_object
+ */
+CCL_CAPI int __cdecl cycles_scene_apply_frame(unsigned int client_id, unsigned int scene_id, unsigned int count, const unsigned int* object_ids,
+	const float* transforms, const unsigned int* shader_ids);
 /**
  * Set cutout flag for object. This object is used for cutout/clipping.
  * \ingroup ccycles_object
@@ -388,11 +473,20 @@ CCL_CAPI void __cdecl cycles_object_set_random_id(unsigned int client_id, unsign
 
 /**
  * Clear clipping planes list.
+ *
+ * Clipping plane changes only update the clipping planes on the device,
+ * objects, meshes and BVH are left alone. Discarded planes are not handed
+ * to Cycles, so they cost nothing during rendering, and setting a plane to
+ * the value it already has doesn't cause an update at all.
  */
 CCL_CAPI void __cdecl cycles_scene_clear_clipping_planes(unsigned int client_id, unsigned int scene_id);
 
 /**
  * Add a clipping plane equation.
+ *
+ * \returns id of the new plane, UINT_MAX if the scene wasn't found. The id
+ * stays valid while other planes are discarded or added, it is not an index
+ * into the planes handed to Cycles.
  */
 CCL_CAPI unsigned int __cdecl cycles_scene_add_clipping_plane(unsigned int client_id, unsigned int scene_id, float a, float b, float c, float d);
 
@@ -402,7 +496,8 @@ CCL_CAPI unsigned int __cdecl cycles_scene_add_clipping_plane(unsigned int clien
 CCL_CAPI void __cdecl cycles_scene_discard_clipping_plane(unsigned int client_id, unsigned int scene_id, unsigned int cp_id);
 
 /**
- * Set a clipping plane equation.
+ * Set a clipping plane equation. Setting a discarded plane brings it back,
+ * an id that wasn't handed out by cycles_scene_add_clipping_plane is ignored.
  */
 CCL_CAPI void __cdecl cycles_scene_set_clipping_plane(unsigned int client_id, unsigned int scene_id, unsigned int cp_id, float a, float b, float c, float d);
 /** Tag integrator for update. */
@@ -415,6 +510,12 @@ CCL_CAPI void __cdecl cycles_integrator_set_min_bounce(unsigned int client_id, u
  * \todo split for caustics_reflective and caustics_refractive.
  */
 CCL_CAPI void __cdecl cycles_integrator_set_no_caustics(unsigned int client_id, unsigned int scene_id, bool no_caustics);
+/** Enable motion blur. Objects and camera are blurred over their motion
+ * transforms, see cycles_scene_object_set_motion and cycles_camera_set_motion,
+ * during the camera shutter time. Integrator, objects, meshes and camera are
+ * tagged for update, so the next reset rebuilds the BVH.
+ */
+CCL_CAPI void __cdecl cycles_integrator_set_motion_blur(unsigned int client_id, unsigned int scene_id, bool motion_blur);
 /** Set to true if shadows shouldn't be traced.
  */
 CCL_CAPI void __cdecl cycles_integrator_set_no_shadows(unsigned int client_id, unsigned int scene_id, bool no_shadows);
@@ -469,6 +570,14 @@ enum class sampling_pattern : unsigned int {
 CCL_CAPI void __cdecl cycles_integrator_set_sampling_pattern(unsigned int client_id, unsigned int scene_id, sampling_pattern pattern);
 CCL_CAPI void __cdecl cycles_integrator_set_sample_clamp_direct(unsigned int client_id, unsigned int scene_id, float sample_clamp_direct);
 CCL_CAPI void __cdecl cycles_integrator_set_sample_clamp_indirect(unsigned int client_id, unsigned int scene_id, float sample_clamp_indirect);
+/**
+ * Set light sampling threshold. Shadow rays of light samples whose
+ * contribution, after falloff and BSDF, is below the threshold get
+ * terminated by Russian roulette, so weak and distant lights stop costing a
+ * shadow ray each. The result stays unbiased. This is the setting to raise
+ * for scenes with many lights: light picking itself is done by the Cycles
+ * kernel and is uniform over lights.
+ */
 CCL_CAPI void __cdecl cycles_integrator_set_light_sampling_threshold(unsigned int client_id, unsigned int scene_id, float light_sampling_threshold);
 
 /** Different camera types. */
@@ -529,6 +638,15 @@ CCL_CAPI void __cdecl cycles_camera_set_bladesrotation(unsigned int client_id, u
 CCL_CAPI void __cdecl cycles_camera_set_focaldistance(unsigned int client_id, unsigned int scene_id, float focaldistance);
 /** Set the shutter time for scene camera. Used mainly with motion blur aspect of rendering process. */
 CCL_CAPI void __cdecl cycles_camera_set_shuttertime(unsigned int client_id, unsigned int scene_id, float shuttertime);
+/**
+ * Set camera motion transforms for motion blur, 12 floats per step in the
+ * same convention as cycles_camera_set_matrix. Steps are spread evenly over
+ * the shutter time and the center one also becomes the camera matrix, so
+ * steps has to be odd. 0 or 1 clears camera motion.
+ *
+ * \returns 0 on success, -1 if scene wasn't found, -2 for an even step count.
+ */
+CCL_CAPI int __cdecl cycles_camera_set_motion(unsigned int client_id, unsigned int scene_id, unsigned int steps, const float* transforms);
 /** Set the field of view for fisheye camera. */
 CCL_CAPI void __cdecl cycles_camera_set_fisheye_fov(unsigned int client_id, unsigned int scene_id, float fisheye_fov);
 /** Set the lens for fisheye camera. */
@@ -541,6 +659,57 @@ CCL_CAPI void __cdecl cycles_session_set_scene(unsigned int client_id, unsigned
 /** Reset session. */
 CCL_CAPI int __cdecl cycles_session_reset(unsigned int client_id, unsigned int session_id, unsigned int width, unsigned int height, unsigned int samples, unsigned int full_x, unsigned int full_y, unsigned int full_width, unsigned int full_height );
 
+/**
+ * Reset session to render only the region x, y, width, height of the frame
+ * set up with the last cycles_session_reset. x and y are measured from the
+ * top-left pixel of that frame, so 0, 0 is at its full_x, full_y. Pixels
+ * outside the region are not rendered. Use
+ * cycles_session_get_composited_buffer to get the frame with the region
+ * composited in. cycles_session_reset_camera and cycles_session_reset_frame
+ * go back to rendering the whole frame.
+ *
+ * \returns 0 on success, -1 if session wasn't found, -2 if the region doesn't
+ * fit the full frame, -13 on a crash.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI int __cdecl cycles_session_reset_region(unsigned int client_id, unsigned int session_id, unsigned int x, unsigned int y, unsigned int width, unsigned int height, unsigned int samples);
+
+/**
+ * Reset session after only the camera of its scene has changed, for instance
+ * during viewport navigation. The camera is tagged for update and accumulation
+ * restarts with the resolution, samples and passes of the last
+ * cycles_session_reset. Film and passes are not re-tagged, so only camera
+ * device data gets updated.
+ *
+ * \returns 0 on success, -1 if session wasn't found, -13 on a crash.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI int __cdecl cycles_session_reset_camera(unsigned int client_id, unsigned int session_id);
+
+/**
+ * Reset session for the next frame of an animation, after its changes have
+ * been applied with cycles_scene_apply_frame and the camera setters.
+ * Resolution, samples and passes stay those of the last cycles_session_reset,
+ * so film and passes aren't re-tagged. The camera is tagged for update.
+ * Images, shaders and meshes that didn't change keep their device data.
+ *
+ * Per-frame sync time is included in cycles_session_get_reset_latency.
+ *
+ * \returns 0 on success, -1 if session wasn't found, -13 on a crash.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI int __cdecl cycles_session_reset_frame(unsigned int client_id, unsigned int session_id);
+
+/**
+ * Get the time in seconds between the last reset of any kind (full, region,
+ * camera-only or frame) and completion of the first cycles_session_sample
+ * call after it.
+ *
+ * \returns latency in seconds, or a negative value if no sample has completed yet.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI double __cdecl cycles_session_get_reset_latency(unsigned int client_id, unsigned int session_id);
+
 CCL_CAPI void __cdecl cycles_session_add_pass(unsigned int client_id, unsigned int session_id, int pass_id);
 CCL_CAPI void __cdecl cycles_session_clear_passes(unsigned int client_id, unsigned int session_id);
 
@@ -550,6 +719,17 @@ CCL_CAPI void __cdecl cycles_session_set_update_callback(unsigned int client_id,
 CCL_CAPI void __cdecl cycles_session_set_cancel_callback(unsigned int client_id, unsigned int session_id, void(*cancel)(unsigned int sid));
 /** Set the render tile update callback for session. */
 CCL_CAPI void __cdecl cycles_session_set_update_tile_callback(unsigned int client_id, unsigned int session_id, RENDER_TILE_CB update_tile_cb);
+/**
+ * Enable (1) or disable (0) progressive preview frames for session.
+ *
+ * When enabled, each frame rendered at a reduced resolution, as set up by
+ * cycles_session_params_set_start_resolution, is upsampled to the full
+ * resolution with edge-aware filtering and pushed through the render tile
+ * update callback as a full frame RGBA PASS_COMBINED buffer. Frames are
+ * pushed from cycles_session_sample as soon as they are ready.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_session_set_progressive_preview(unsigned int client_id, unsigned int session_id, unsigned int enable);
 /** Set the render tile write callback for session. */
 CCL_CAPI void __cdecl cycles_session_set_write_tile_callback(unsigned int client_id, unsigned int session_id, RENDER_TILE_CB write_tile_cb);
 /** Set the display update callback for session. */
@@ -568,7 +748,152 @@ CCL_CAPI bool __cdecl cycles_session_is_paused(unsigned int client_id, unsigned
 CCL_CAPI void __cdecl cycles_session_set_samples(unsigned int client_id, unsigned int session_id, int samples);
 /** Clear resources for session. */
 CCL_CAPI void __cdecl cycles_session_destroy(unsigned int client_id, unsigned int session_id, unsigned int scene_id);
+
+/**
+ * Set the maximum number of idle sessions to keep in the session pool.
+ *
+ * With a capacity larger than 0 cycles_session_destroy doesn't free the
+ * Cycles session, but releases its scene and keeps device, loaded kernels
+ * and buffers around. A later cycles_session_create with equal session
+ * parameters reuses a pooled session. Default capacity is 0, no pooling.
+ * Lowering the capacity frees pooled sessions over the new limit.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_session_pool_set_capacity(unsigned int client_id, unsigned int capacity);
+/** Get the number of idle sessions currently in the session pool. */
+CCL_CAPI unsigned int __cdecl cycles_session_pool_size(unsigned int client_id);
+/** Free all idle sessions in the session pool. */
+CCL_CAPI void __cdecl cycles_session_pool_clear(unsigned int client_id);
+
+/**
+ * Set the maximum number of sessions that may run cycles_session_sample at
+ * the same time. Sessions over the limit block in cycles_session_sample
+ * until it is their turn. 0 (default) disables the render scheduler.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_scheduler_set_max_concurrent(unsigned int client_id, unsigned int max_concurrent);
+/**
+ * Cap the render threads of sessions created after this call. Session
+ * parameters asking for more threads, or for automatic thread count, are
+ * clamped to max_threads. 0 (default) means no cap.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_scheduler_set_max_threads(unsigned int client_id, unsigned int max_threads);
+/**
+ * Set scheduler priority for session. While a session with higher priority
+ * is sampling or waiting to sample, sessions with lower priority don't get
+ * to sample. Use for instance 1 for viewport sessions and 0 (default) for
+ * background thumbnail sessions.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_session_set_priority(unsigned int client_id, unsigned int session_id, int priority);
+/**
+ * Set scheduler weight for session. Sessions with equal priority get
+ * samples in proportion to their weight. Default is 1.0.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_session_set_weight(unsigned int client_id, unsigned int session_id, float weight);
+/**
+ * Get measured render throughput of session in pixel samples per second,
+ * and utilization: the fraction of the time since the last reset the
+ * session spent sampling. Throughput is that of the current render once
+ * it has run for a moment, before that of earlier renders; 0 if the
+ * session never rendered.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_session_get_throughput(unsigned int client_id, unsigned int session_id, double* pixel_samples_per_second, double* utilization);
+/**
+ * Split the full frame across sessions rendering on different devices,
+ * in proportion to their measured throughput. This balances separate
+ * sessions, each with a device of its own, not the sub-devices of a
+ * device from cycles_create_multidevice. Each session gets a band of
+ * full rows, stacked top to bottom in the order given, and is reset to
+ * render only that band with samples samples, as with
+ * cycles_session_reset_region. Sessions without measurement get an equal
+ * share. Call again after a frame to rebalance on the new measurements.
+ *
+ * All sessions must have been reset with cycles_session_reset to the same
+ * full frame size.
+ *
+ * \returns 0 on success, -1 if a session wasn't found, -2 if the sessions
+ * don't share a full frame or there are more sessions than rows, otherwise
+ * the error of cycles_session_reset_region.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI int __cdecl cycles_session_group_balance(unsigned int client_id, unsigned int count, const unsigned int* session_ids, unsigned int samples);
 CCL_CAPI void __cdecl cycles_session_get_float_buffer(unsigned int client_id, unsigned int session_id, int passtype, float** pixels);
+/**
+ * Get the retained RGBA buffer for passtype, sized to the frame of the last
+ * cycles_session_reset, with the currently rendered region composited into it. For full frame renders this is just a
+ * copy of the render result. The buffer is owned by the session and stays
+ * valid until the next call for the same pass or session destruction.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_session_get_composited_buffer(unsigned int client_id, unsigned int session_id, int passtype, float** pixels);
+/**
+ * Set up the CPU denoiser of session. iterations 0 disables it, each further
+ * iteration doubles the filter footprint and costs one more pass over the
+ * frame, up to 8. 4 or 5 is a good start. strength scales the color range
+ * averaged over, 1.0 is the default.
+ *
+ * The denoiser filters the Combined pass, guided by the Normal and DiffCol
+ * passes if they have been added to the session. With progressive 1 every
+ * sample gets denoised, otherwise only the last one. Denoised frames are
+ * pushed through the render tile update callback as full frame RGBA
+ * PASS_COMBINED buffers and can be read with cycles_session_get_denoised_buffer.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_session_set_denoising(unsigned int client_id, unsigned int session_id, unsigned int iterations, float strength, unsigned int progressive);
+/**
+ * Denoise the current frame of session now.
+ *
+ * \returns 0 on success, -1 if session wasn't found, -2 if denoising is
+ * disabled or no full resolution frame has been rendered yet.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI int __cdecl cycles_session_denoise(unsigned int client_id, unsigned int session_id);
+/**
+ * Get the last denoised RGBA frame of session and the seconds denoising it
+ * took. pixels is set to nullptr if no frame has been denoised since the last
+ * reset. The buffer is owned by the session.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_session_get_denoised_buffer(unsigned int client_id, unsigned int session_id, float** pixels, double* denoise_time);
+/**
+ * Write all registered passes of session as layers of one tiled EXR file.
+ *
+ * The pass buffers are copied on the calling thread, after that the session
+ * can continue rendering. The file is written on a dedicated writer pool,
+ * tile compression runs on the OpenEXR global thread pool, see
+ * cycles_exr_set_compression_threads. Combined goes to the
+ * R, G, B and A channels, other passes to layers named after the pass
+ * (Depth.Z, Normal.X, IndexOB.X and so on). tile_size 0 means 64.
+ * Use cycles_session_wait_exr to wait for the write to finish.
+ *
+ * \returns 0 when queued, -1 if session wasn't found or got destroyed, -2
+ *          if no pass had data at full resolution.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI int __cdecl cycles_session_write_exr(unsigned int client_id, unsigned int session_id, const char* filename, unsigned int tile_size);
+/**
+ * Wait for all EXR writes queued for session to finish.
+ *
+ * \returns 0 on success, -3 if any of the writes failed.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI int __cdecl cycles_session_wait_exr(unsigned int client_id, unsigned int session_id);
+/**
+ * Set the number of threads of the EXR writer pool (default 1).
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_exr_set_threads(unsigned int client_id, unsigned int writer_threads);
+/**
+ * Set the OpenEXR global thread count used for tile compression, 0 to
+ * compress on the writer thread. This changes the thread count of OpenEXR
+ * for the whole host process, ccycles leaves it alone otherwise.
+ * \ingroup ccycles_session
+ */
+CCL_CAPI void __cdecl cycles_exr_set_compression_threads(unsigned int client_id, unsigned int compression_threads);
 /** Get pixel data buffer pointer. */
 CCL_CAPI void __cdecl cycles_session_prepare_run(unsigned int client_id, unsigned int session_id);
 CCL_CAPI int __cdecl cycles_session_sample(unsigned int client_id, unsigned int session_id);
@@ -621,6 +946,25 @@ CCL_CAPI bool __cdecl cycles_scene_try_lock(unsigned int client_id, unsigned int
 CCL_CAPI void __cdecl cycles_scene_lock(unsigned int client_id, unsigned int scene_id);
 CCL_CAPI void __cdecl cycles_scene_unlock(unsigned int client_id, unsigned int scene_id);
 
+/** Parts of a scene that can be tagged for update, see cycles_scene_get_update_flags. */
+enum class scene_update_flags : unsigned int {
+	NONE = 0,
+	OBJECTS = 1 << 0,
+	MESHES = 1 << 1,
+	CAMERA = 1 << 2,
+	INTEGRATOR = 1 << 3,
+	LIGHTS = 1 << 4,
+	IMAGES = 1 << 5
+};
+/**
+ * Get the parts of scene that are tagged for update, as scene_update_flags
+ * bits. These get synced to the device by the next reset.
+ *
+ * \returns update flags, 0 if the scene wasn't found.
+ * \ingroup ccycles_scene
+ */
+CCL_CAPI unsigned int __cdecl cycles_scene_get_update_flags(unsigned int client_id, unsigned int scene_id);
+
 /* Mesh geometry API */
 CCL_CAPI void __cdecl cycles_mesh_set_verts(unsigned int client_id, unsigned int scene_id, unsigned int mesh_id, float *verts, unsigned int vcount);
 CCL_CAPI void __cdecl cycles_mesh_set_tris(unsigned int client_id, unsigned int scene_id, unsigned int mesh_id, int *faces, unsigned int fcount, unsigned int shader_id, unsigned int smooth);
@@ -748,6 +1092,17 @@ CCL_CAPI void __cdecl cycles_shadernode_set_member_vec4_at_index(unsigned int cl
 CCL_CAPI void __cdecl cycles_shadernode_set_member_float_img(unsigned int client_id, unsigned int scene_id, unsigned int shader_id, unsigned int shnode_id, shadernode_type shn_type, const char* member_name, const char* img_name, float* img, unsigned int width, unsigned int height, unsigned int depth, unsigned int channels);
 CCL_CAPI void __cdecl cycles_shadernode_set_member_byte_img(unsigned int client_id, unsigned int scene_id, unsigned int shader_id, unsigned int shnode_id, shadernode_type shn_type, const char* member_name, const char* img_name, unsigned char* img, unsigned int width, unsigned int height, unsigned int depth, unsigned int channels);
 
+/**
+ * Get the number of times images of scene were tagged for reloading by
+ * cycles_shadernode_set_member_float_img and cycles_shadernode_set_member_byte_img.
+ * Setting pixels identical to those an image of the same name already holds
+ * doesn't tag it.
+ *
+ * \returns reload count, 0 if the scene wasn't found.
+ * \ingroup ccycles_shader
+ */
+CCL_CAPI unsigned int __cdecl cycles_scene_image_reload_count(unsigned int client_id, unsigned int scene_id);
+
 CCL_CAPI void __cdecl cycles_shader_set_name(unsigned int client_id, unsigned int scene_id, unsigned int shader_id, const char* name);
 CCL_CAPI void __cdecl cycles_shader_set_use_mis(unsigned int client_id, unsigned int scene_id, unsigned int shader_id, unsigned int use_mis);
 CCL_CAPI void __cdecl cycles_shader_set_use_transparent_shadow(unsigned int client_id, unsigned int scene_id, unsigned int shader_id, unsigned int use_transparent_shadow);
@@ -756,6 +1111,26 @@ CCL_CAPI void __cdecl cycles_shader_new_graph(unsigned int client_id, unsigned i
 
 CCL_CAPI void __cdecl cycles_shader_connect_nodes(unsigned int client_id, unsigned int scene_id, unsigned int shader_id, unsigned int from_id, const char* from, unsigned int to_id, const char* to);
 
+/**
+ * Simplify the node graph of a shader once it is complete and report what
+ * got removed: constant math, vector math and mix chains are folded,
+ * identical nodes such as duplicate texture lookups merged and nodes that
+ * don't contribute to the output removed. Each removed node is reported
+ * through the logger.
+ *
+ * Shader compile runs the same simplification, so the compiled shader is
+ * the same whether this is called or not. Use it to find out which parts
+ * of a graph are redundant.
+ *
+ * Call after all nodes have been added and connected; removed node ids can
+ * no longer be addressed.
+ *
+ * \returns number of nodes removed, 0 if nothing could be removed, -1 if
+ * scene or shader wasn't found, -2 if the graph was already simplified.
+ * \ingroup ccycles_shader
+ */
+CCL_CAPI int __cdecl cycles_shader_optimize_graph(unsigned int client_id, unsigned int scene_id, unsigned int shader_id);
+
 /***** LIGHTS ****/
 
 /**
@@ -0,0 +1,309 @@
+/**
+Copyright 2014-2017 Robert McNeel and Associates
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**/
+
+#include "internal_types.h"
+#include "util_task.h"
+
+#include <cmath>
+#include <functional>
+
+extern std::vector<RENDER_TILE_CB> update_cbs;
+
+/* Guide buffers of one frame, all RGBA. normal and albedo may be nullptr
+ * if the session doesn't render that pass.
+ */
+struct DenoiseGuides {
+	const float* normal{ nullptr };
+	const float* albedo{ nullptr };
+};
+
+static inline float denoise_lum(const float* p)
+{
+	return 0.2126f * p[0] + 0.7152f * p[1] + 0.0722f * p[2];
+}
+
+/* Albedo used to demodulate a pixel. Pixels without diffuse component
+ * (glossy, emission, background) are filtered as they are.
+ */
+static inline void denoise_albedo(const DenoiseGuides& g, size_t i, float a[3])
+{
+	if (g.albedo) {
+		const float* p = g.albedo + i * 4;
+		if (ccl::max(p[0], ccl::max(p[1], p[2])) > 1e-2f) {
+			a[0] = ccl::max(p[0], 1e-2f);
+			a[1] = ccl::max(p[1], 1e-2f);
+			a[2] = ccl::max(p[2], 1e-2f);
+			return;
+		}
+	}
+	a[0] = a[1] = a[2] = 1.0f;
+}
+
+/* Normalized normal of a normal pass pixel. Normals are averaged over
+ * samples, so they are shorter than unit length at silhouettes, on thin
+ * geometry and with motion blur. Returns false for pixels without normal.
+ */
+static inline bool denoise_normal(const float* p, float n[3])
+{
+	const float len2 = p[0] * p[0] + p[1] * p[1] + p[2] * p[2];
+	if (len2 <= 1e-12f) return false;
+	const float inv = 1.0f / sqrtf(len2);
+	n[0] = p[0] * inv;
+	n[1] = p[1] * inv;
+	n[2] = p[2] * inv;
+	return true;
+}
+
+/* One level of the edge-avoiding a-trous wavelet filter: a 5x5 B3 spline
+ * kernel with taps step pixels apart, each tap weighted down when its
+ * colour, normal or albedo differs from the center pixel. The center tap
+ * keeps its kernel weight. Colors are compared tone mapped (tone, RGBA),
+ * so bright pixels don't get a wider range than dark ones. Filters rows
+ * y0 to y1 of src into dst.
+ */
+static void denoise_atrous_rows(const float* src, const float* tone, float* dst, int w, int h, int y0, int y1, int step, float sigma_color, const DenoiseGuides& g)
+{
+	static const float kernel[5] = { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+	const float inv_sigma_color = 1.0f / (sigma_color * sigma_color);
+	const float inv_sigma_albedo = 1.0f / (0.1f * 0.1f);
+
+	for (int y = y0; y < y1; y++) {
+		for (int x = 0; x < w; x++) {
+			const size_t ip = (size_t)y * w + x;
+			const float* tp = tone + ip * 4;
+			const float* ap = g.albedo ? g.albedo + ip * 4 : nullptr;
+			float np[3];
+			const bool np_valid = g.normal && denoise_normal(g.normal + ip * 4, np);
+
+			float acc[3] = { 0.0f, 0.0f, 0.0f };
+			float wsum = 0.0f;
+			for (int ky = -2; ky <= 2; ky++) {
+				const int qy = y + ky * step;
+				if (qy < 0 || qy >= h) continue;
+				for (int kx = -2; kx <= 2; kx++) {
+					const int qx = x + kx * step;
+					if (qx < 0 || qx >= w) continue;
+					const size_t iq = (size_t)qy * w + qx;
+					const float* cq = src + iq * 4;
+					float wq = kernel[ky + 2] * kernel[kx + 2];
+					if (iq == ip) {
+						acc[0] += wq * cq[0];
+						acc[1] += wq * cq[1];
+						acc[2] += wq * cq[2];
+						wsum += wq;
+						continue;
+					}
+					const float* tq = tone + iq * 4;
+
+					float e = 0.0f;
+					for (int c = 0; c < 3; c++) {
+						const float dc = tp[c] - tq[c];
+						e += dc * dc * inv_sigma_color;
+					}
+					if (ap) {
+						const float* aq = g.albedo + iq * 4;
+						for (int c = 0; c < 3; c++) {
+							const float dc = ap[c] - aq[c];
+							e += dc * dc * inv_sigma_albedo;
+						}
+					}
+					if (g.normal) {
+						float nq[3];
+						const bool nq_valid = denoise_normal(g.normal + iq * 4, nq);
+						if (np_valid != nq_valid) continue;
+						if (np_valid) {
+							float dot = ccl::max(np[0] * nq[0] + np[1] * nq[1] + np[2] * nq[2], 0.0f);
+							/* dot^32, sharp enough to keep creases. */
+							dot *= dot; dot *= dot; dot *= dot; dot *= dot; dot *= dot;
+							wq *= dot;
+						}
+					}
+					wq *= expf(-e);
+
+					acc[0] += wq * cq[0];
+					acc[1] += wq * cq[1];
+					acc[2] += wq * cq[2];
+					wsum += wq;
+				}
+			}
+
+			float* o = dst + ip * 4;
+			const float* cp = src + ip * 4;
+			if (wsum > 0.0f) {
+				const float inv = 1.0f / wsum;
+				o[0] = acc[0] * inv;
+				o[1] = acc[1] * inv;
+				o[2] = acc[2] * inv;
+			}
+			else {
+				o[0] = cp[0];
+				o[1] = cp[1];
+				o[2] = cp[2];
+			}
+			o[3] = cp[3];
+		}
+	}
+}
+
+/* Denoise RGBA color of w*h pixels into out. Texture detail is protected by
+ * filtering color divided by albedo and multiplying back afterwards.
+ * Every iteration doubles the filter footprint.
+ */
+static void denoise_frame(const float* color, float* out, int w, int h, int iterations, float strength, const DenoiseGuides& g, int threads)
+{
+	const size_t n = (size_t)w * h;
+	std::vector<float> ping(n * 4);
+
+	for (size_t i = 0; i < n; i++) {
+		float a[3];
+		denoise_albedo(g, i, a);
+		out[i * 4 + 0] = color[i * 4 + 0] / a[0];
+		out[i * 4 + 1] = color[i * 4 + 1] / a[1];
+		out[i * 4 + 2] = color[i * 4 + 2] / a[2];
+		out[i * 4 + 3] = color[i * 4 + 3];
+	}
+
+	if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+	threads = ccl::clamp(threads, 1, h);
+
+	/* Bands of rows run on the Cycles task scheduler the session already
+	 * started, instead of spawning threads for every iteration.
+	 */
+	ccl::TaskPool pool;
+	std::vector<float> tone(n * 4);
+	float* src = out;
+	float* dst = ping.data();
+	float sigma_color = 0.5f * strength;
+	for (int it = 0; it < iterations; it++) {
+		const int step = 1 << it;
+		for (size_t i = 0; i < n; i++) {
+			const float t = 1.0f / (1.0f + ccl::max(denoise_lum(src + i * 4), 0.0f));
+			tone[i * 4 + 0] = src[i * 4 + 0] * t;
+			tone[i * 4 + 1] = src[i * 4 + 1] * t;
+			tone[i * 4 + 2] = src[i * 4 + 2] * t;
+		}
+		for (int t = 0; t < threads; t++) {
+			const int y0 = h * t / threads;
+			const int y1 = h * (t + 1) / threads;
+			pool.push(function_bind(&denoise_atrous_rows, src, tone.data(), dst, w, h, y0, y1, step, sigma_color, std::cref(g)));
+		}
+		pool.wait_work();
+		std::swap(src, dst);
+		/* Coarser levels only smooth what is left of the noise. */
+		sigma_color *= 0.5f;
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		float a[3];
+		denoise_albedo(g, i, a);
+		out[i * 4 + 0] = src[i * 4 + 0] * a[0];
+		out[i * 4 + 1] = src[i * 4 + 1] * a[1];
+		out[i * 4 + 2] = src[i * 4 + 2] * a[2];
+		out[i * 4 + 3] = src[i * 4 + 3];
+	}
+}
+
+bool CCSession::denoise(int sample)
+{
+	ccl::DeviceDrawParams draw_params = ccl::DeviceDrawParams();
+	draw_params.bind_display_space_shader_cb = nullptr;
+	draw_params.unbind_display_space_shader_cb = nullptr;
+
+	const int w = buffer_params.width;
+	const int h = buffer_params.height;
+
+	/* Get pixels of pass, nullptr if not rendered or not at final resolution. */
+	auto pass_pixels = [&](ccl::PassType pt) -> const float* {
+		if (!ccl::Pass::contains(buffer_params.passes, pt)) return nullptr;
+		ccl::DisplayBuffer* db = session->display_buffers[pt];
+		if (db == nullptr) return nullptr;
+		const float* pixels = (const float*)db->prepare_pixels(session->device, draw_params);
+		if (pixels == nullptr || db->draw_width != w || db->draw_height != h) return nullptr;
+		return pixels;
+	};
+
+	const float* color = pass_pixels(ccl::PASS_COMBINED);
+	if (color == nullptr || w <= 0 || h <= 0) return false;
+
+	DenoiseGuides guides;
+	guides.normal = pass_pixels(ccl::PASS_NORMAL);
+	guides.albedo = pass_pixels(ccl::PASS_DIFFUSE_COLOR);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	denoised_pixels.resize((size_t)w * h * 4);
+	denoise_frame(color, denoised_pixels.data(), w, h, denoise_iterations, denoise_strength, guides, params.threads);
+	denoised_sample = sample;
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	denoise_time = elapsed.count();
+
+	if (update_cbs[id] != nullptr) {
+		update_cbs[id](id, 0, 0, w, h, sample, 4, ccl::PassType::PASS_COMBINED, denoised_pixels.data(), (int)denoised_pixels.size());
+	}
+	return true;
+}
+
+void CCSession::denoise_after_sample(int sample)
+{
+	if (denoise_iterations <= 0) return;
+	if (!denoise_progressive && !session->tile_manager.done()) return;
+	denoise(sample);
+}
+
+void cycles_session_set_denoising(unsigned int client_id, unsigned int session_id, unsigned int iterations, float strength, unsigned int progressive)
+{
+	CCSession* ccsess = nullptr;
+	ccl::Session* session = nullptr;
+	if (session_find(session_id, &ccsess, &session)) {
+		ccsess->denoise_iterations = (int)ccl::min(iterations, 8u);
+		ccsess->denoise_strength = strength > 0.0f ? strength : 1.0f;
+		ccsess->denoise_progressive = progressive == 1;
+		ccsess->denoised_sample = -1;
+		if (ccsess->denoise_iterations == 0) {
+			ccsess->denoised_pixels.clear();
+			ccsess->denoised_pixels.shrink_to_fit();
+		}
+		logger.logit(client_id, "Set denoising for session ", session_id, " to ", iterations, " iterations, strength ", strength, ", progressive ", progressive);
+	}
+}
+
+int cycles_session_denoise(unsigned int client_id, unsigned int session_id)
+{
+	CCSession* ccsess = nullptr;
+	ccl::Session* session = nullptr;
+	if (!session_find(session_id, &ccsess, &session)) return -1;
+	if (ccsess->denoise_iterations <= 0) return -2;
+
+	if (!ccsess->denoise(session->tile_manager.state.sample)) return -2;
+
+	logger.logit(client_id, "Denoised session ", session_id, " in ", ccsess->denoise_time, "s");
+	return 0;
+}
+
+void cycles_session_get_denoised_buffer(unsigned int client_id, unsigned int session_id, float** pixels, double* denoise_time)
+{
+	*pixels = nullptr;
+	*denoise_time = -1.0;
+
+	CCSession* ccsess = nullptr;
+	ccl::Session* session = nullptr;
+	if (session_find(session_id, &ccsess, &session)) {
+		if (ccsess->denoised_sample < 0 || ccsess->denoised_pixels.empty()) return;
+		*pixels = ccsess->denoised_pixels.data();
+		*denoise_time = ccsess->denoise_time;
+	}
+}
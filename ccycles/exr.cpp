@@ -0,0 +1,302 @@
+/**
+Copyright 2014-2017 Robert McNeel and Associates
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**/
+
+#include "internal_types.h"
+
+#include <memory>
+
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfThreading.h>
+#include <ImfTileDescription.h>
+#include <ImfTiledOutputFile.h>
+#include <IlmThreadPool.h>
+#include <ImathBox.h>
+#include <half.h>
+
+/* One channel of a pass layer: EXR channel name, component in the RGBA
+ * display buffer and pixel type to store it as.
+ */
+struct ExrChannel {
+	const char* name;
+	int component;
+	Imf::PixelType type;
+};
+
+/* Channel layout per supported pass. Combined goes unprefixed so image
+ * viewers show it by default, all other passes become named layers. Data
+ * passes are stored as full floats, ids must survive the round trip exactly.
+ */
+static std::vector<ExrChannel> exr_channels(ccl::PassType pt)
+{
+	switch (pt) {
+		case ccl::PASS_COMBINED:
+			return { {"R", 0, Imf::HALF}, {"G", 1, Imf::HALF}, {"B", 2, Imf::HALF}, {"A", 3, Imf::HALF} };
+		case ccl::PASS_DEPTH:
+			return { {"Depth.Z", 0, Imf::FLOAT} };
+		case ccl::PASS_NORMAL:
+			return { {"Normal.X", 0, Imf::FLOAT}, {"Normal.Y", 1, Imf::FLOAT}, {"Normal.Z", 2, Imf::FLOAT} };
+		case ccl::PASS_DIFFUSE_COLOR:
+			return { {"DiffCol.R", 0, Imf::HALF}, {"DiffCol.G", 1, Imf::HALF}, {"DiffCol.B", 2, Imf::HALF} };
+		case ccl::PASS_OBJECT_ID:
+			return { {"IndexOB.X", 0, Imf::FLOAT} };
+		case ccl::PASS_MATERIAL_ID:
+			return { {"IndexMA.X", 0, Imf::FLOAT} };
+		case ccl::PASS_UV:
+			return { {"UV.U", 0, Imf::FLOAT}, {"UV.V", 1, Imf::FLOAT} };
+		default:
+			return {};
+	}
+}
+
+/* Snapshot of all pass buffers of a session, taken on the calling thread so
+ * the session can continue rendering while the snapshot gets written.
+ */
+struct ExrFrame {
+	std::string filename;
+	int tile_size{ 64 };
+	Imath::Box2i display_window;
+	Imath::Box2i data_window;
+	std::vector<std::pair<ccl::PassType, std::vector<float>>> passes;
+};
+
+/* Pending writes of one session. Tasks report errors through failed. The
+ * writer is shared by the writer map, callers and queued tasks, so a session
+ * destroyed while another thread waits or queues a write doesn't free it
+ * under them. group is reset to nullptr once the session is released.
+ */
+struct ExrSessionWriter {
+	ccl::thread_mutex group_mutex;
+	std::unique_ptr<IlmThread::TaskGroup> group{ new IlmThread::TaskGroup() };
+
+	ccl::thread_mutex error_mutex;
+	int failed{ 0 };
+	std::string last_error;
+};
+
+/* Dedicated pool running the write tasks, so neither render threads nor
+ * the global OpenEXR pool doing the tile compression get blocked by file
+ * I/O. Created on first use.
+ */
+static ccl::thread_mutex exr_mutex;
+static std::unique_ptr<IlmThread::ThreadPool> exr_pool;
+static unsigned int exr_writer_threads{ 1 };
+static std::map<unsigned int, std::shared_ptr<ExrSessionWriter>> exr_writers;
+
+/* A task never holds the last reference to its writer: the writer map holds
+ * one until _exr_session_release, which waits for all tasks while holding a
+ * reference of its own.
+ */
+class ExrWriteTask : public IlmThread::Task {
+public:
+	ExrWriteTask(IlmThread::TaskGroup* group, std::shared_ptr<ExrSessionWriter> writer_, ExrFrame* frame_)
+		: IlmThread::Task(group), writer(std::move(writer_)), frame(frame_) {}
+
+	void execute() override
+	{
+		try {
+			write();
+		}
+		catch (std::exception& e) {
+			ccl::thread_scoped_lock lock(writer->error_mutex);
+			writer->failed++;
+			writer->last_error = e.what();
+		}
+		catch (...) {
+			ccl::thread_scoped_lock lock(writer->error_mutex);
+			writer->failed++;
+			writer->last_error = "unknown error writing " + frame->filename;
+		}
+	}
+
+private:
+	void write()
+	{
+		const Imath::Box2i& dw = frame->data_window;
+		const int w = dw.max.x - dw.min.x + 1;
+		const int h = dw.max.y - dw.min.y + 1;
+		const size_t xstride = sizeof(float) * 4;
+		const size_t ystride = xstride * w;
+		const size_t origin = (size_t)dw.min.y * w + dw.min.x;
+
+		Imf::Header header(frame->display_window, frame->data_window);
+		header.compression() = Imf::ZIP_COMPRESSION;
+		header.setTileDescription(Imf::TileDescription(frame->tile_size, frame->tile_size, Imf::ONE_LEVEL));
+
+		/* Output slices must have the channel's pixel type, half channels
+		 * get converted into planes of their own.
+		 */
+		std::vector<std::vector<half>> planes;
+
+		Imf::FrameBuffer fb;
+		for (auto& pass : frame->passes) {
+			/* Slices are addressed in data window coordinates. */
+			char* base = (char*)pass.second.data() - origin * xstride;
+			for (const ExrChannel& ch : exr_channels(pass.first)) {
+				header.channels().insert(ch.name, Imf::Channel(ch.type));
+				if (ch.type == Imf::FLOAT) {
+					fb.insert(ch.name, Imf::Slice(Imf::FLOAT, base + ch.component * sizeof(float), xstride, ystride));
+					continue;
+				}
+
+				planes.emplace_back((size_t)w * h);
+				half* plane = planes.back().data();
+				const float* src = pass.second.data() + ch.component;
+				for (size_t i = 0; i < (size_t)w * h; i++) {
+					plane[i] = half(src[i * 4]);
+				}
+				fb.insert(ch.name, Imf::Slice(Imf::HALF, (char*)(plane - origin), sizeof(half), sizeof(half) * w));
+			}
+		}
+
+		Imf::TiledOutputFile out(frame->filename.c_str(), header);
+		out.setFrameBuffer(fb);
+
+		/* Hand tiles over row by row, OpenEXR compresses the tiles of a row
+		 * in parallel on its global pool while the previous row is written.
+		 */
+		const int nx = out.numXTiles();
+		const int ny = out.numYTiles();
+		for (int ty = 0; ty < ny; ty++) {
+			out.writeTiles(0, nx - 1, ty, ty);
+		}
+	}
+
+	std::shared_ptr<ExrSessionWriter> writer;
+	std::unique_ptr<ExrFrame> frame;
+};
+
+/* Get writer for session, creating it and the pool on first use. */
+static std::shared_ptr<ExrSessionWriter> exr_writer_get(unsigned int session_id)
+{
+	ccl::thread_scoped_lock lock(exr_mutex);
+	if (!exr_pool) {
+		exr_pool.reset(new IlmThread::ThreadPool(exr_writer_threads));
+	}
+	std::shared_ptr<ExrSessionWriter>& writer = exr_writers[session_id];
+	if (!writer) {
+		writer = std::make_shared<ExrSessionWriter>();
+	}
+	return writer;
+}
+
+void cycles_exr_set_threads(unsigned int client_id, unsigned int writer_threads)
+{
+	ccl::thread_scoped_lock lock(exr_mutex);
+	exr_writer_threads = writer_threads > 0 ? writer_threads : 1;
+	if (exr_pool) {
+		exr_pool->setNumThreads(exr_writer_threads);
+	}
+	logger.logit(client_id, "Set EXR writer threads to ", exr_writer_threads);
+}
+
+void cycles_exr_set_compression_threads(unsigned int client_id, unsigned int compression_threads)
+{
+	Imf::setGlobalThreadCount(compression_threads);
+	logger.logit(client_id, "Set OpenEXR global thread count to ", compression_threads);
+}
+
+int cycles_session_write_exr(unsigned int client_id, unsigned int session_id, const char* filename, unsigned int tile_size)
+{
+	CCSession* ccsess = nullptr;
+	ccl::Session* session = nullptr;
+	if (!session_find(session_id, &ccsess, &session)) return -1;
+
+	ccl::DeviceDrawParams draw_params = ccl::DeviceDrawParams();
+	draw_params.bind_display_space_shader_cb = nullptr;
+	draw_params.unbind_display_space_shader_cb = nullptr;
+
+	const ccl::BufferParams& bp = ccsess->buffer_params;
+	if (bp.width <= 0 || bp.height <= 0) return -2;
+
+	std::unique_ptr<ExrFrame> frame(new ExrFrame());
+	frame->filename = filename;
+	frame->tile_size = tile_size > 0 ? (int)tile_size : 64;
+	frame->display_window = Imath::Box2i(Imath::V2i(0, 0), Imath::V2i(bp.full_width - 1, bp.full_height - 1));
+	frame->data_window = Imath::Box2i(Imath::V2i(bp.full_x, bp.full_y), Imath::V2i(bp.full_x + bp.width - 1, bp.full_y + bp.height - 1));
+
+	const size_t size = (size_t)bp.width * bp.height * 4;
+	for (const ccl::Pass& pass : bp.passes) {
+		ccl::DisplayBuffer* db = session->display_buffers[pass.type];
+		if (db == nullptr || exr_channels(pass.type).empty()) continue;
+
+		float* pixels = (float*)db->prepare_pixels(session->device, draw_params);
+		/* Coarse start resolution frames don't match the data window. */
+		if (pixels == nullptr || db->draw_width != bp.width || db->draw_height != bp.height) continue;
+
+		frame->passes.emplace_back(pass.type, std::vector<float>(pixels, pixels + size));
+	}
+
+	if (frame->passes.empty()) return -2;
+
+	std::shared_ptr<ExrSessionWriter> writer = exr_writer_get(session_id);
+	{
+		ccl::thread_scoped_lock lock(writer->group_mutex);
+		/* Session was destroyed since it was found. */
+		if (!writer->group) return -1;
+		exr_pool->addTask(new ExrWriteTask(writer->group.get(), writer, frame.release()));
+	}
+
+	logger.logit(client_id, "Queued EXR write of session ", session_id, " to ", filename);
+	return 0;
+}
+
+int cycles_session_wait_exr(unsigned int client_id, unsigned int session_id)
+{
+	std::shared_ptr<ExrSessionWriter> writer;
+	{
+		ccl::thread_scoped_lock lock(exr_mutex);
+		auto it = exr_writers.find(session_id);
+		if (it == exr_writers.end()) return 0;
+		writer = it->second;
+	}
+
+	{
+		/* TaskGroup destructor blocks until all its tasks are done. A
+		 * released writer has no group left and nothing to wait for.
+		 */
+		ccl::thread_scoped_lock lock(writer->group_mutex);
+		if (writer->group) {
+			writer->group.reset(new IlmThread::TaskGroup());
+		}
+	}
+
+	ccl::thread_scoped_lock lock(writer->error_mutex);
+	int failed = writer->failed;
+	if (failed > 0) {
+		logger.logit(client_id, "EXR write of session ", session_id, " failed: ", writer->last_error);
+	}
+	writer->failed = 0;
+	return failed > 0 ? -3 : 0;
+}
+
+/* Wait for and drop the writer of session, called when session goes away. */
+void _exr_session_release(unsigned int session_id)
+{
+	std::shared_ptr<ExrSessionWriter> writer;
+	{
+		ccl::thread_scoped_lock lock(exr_mutex);
+		auto it = exr_writers.find(session_id);
+		if (it == exr_writers.end()) return;
+		writer = std::move(it->second);
+		exr_writers.erase(it);
+	}
+	{
+		ccl::thread_scoped_lock lock(writer->group_mutex);
+		writer->group.reset();
+	}
+}
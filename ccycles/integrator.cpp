@@ -54,6 +54,21 @@ void cycles_integrator_set_no_caustics(unsigned int client_id, unsigned int scen
 	}
 }
 
+void cycles_integrator_set_motion_blur(unsigned int client_id, unsigned int scene_id, bool motion_blur)
+{
+	CCScene* csce = nullptr;
+	ccl::Scene* sce = nullptr;
+	if(scene_find(scene_id, &csce, &sce)) {
+		sce->integrator->motion_blur = motion_blur;
+		sce->integrator->tag_update(sce);
+		/* Objects need their motion uploaded, or dropped, and the BVH
+		 * has to be rebuilt with or without motion nodes. */
+		sce->object_manager->tag_update(sce);
+		sce->mesh_manager->tag_update(sce);
+		sce->camera->need_update = true;
+	}
+}
+
 void cycles_integrator_set_no_shadows(unsigned int client_id, unsigned int scene_id, bool no_shadows)
 {
 #if 0
@@ -17,11 +17,13 @@ limitations under the License.
 #pragma once
 
 #include <vector>
+#include <map>
 #include <chrono>
 #include <ctime>
 #include <thread>
 #include <mutex>
 #include <string>
+#include <cstdint>
 
 #pragma warning ( push )
 
@@ -144,6 +146,9 @@ struct CCImage {
 		int depth;
 		int channels;
 		bool is_float;
+
+		/* Hash of the pixels last set, to skip reloads of unchanged images. */
+		uint64_t content_hash{ 0 };
 };
 
 #ifndef GLuint
@@ -179,6 +184,79 @@ public:
 	int height{ 0 };
 
 	ccl::BufferParams buffer_params;
+	/* Buffer parameters of the last cycles_session_reset. buffer_params
+	 * differs from these only while a region is rendered.
+	 */
+	ccl::BufferParams full_buffer_params;
+
+	/* Time of the last reset, used to measure latency until the first
+	 * sample of the new render has been completed.
+	 */
+	std::chrono::steady_clock::time_point reset_time;
+	/* Seconds between last reset and first completed sample. Negative
+	 * while no sample has completed since the reset.
+	 */
+	double reset_latency{ -1.0 };
+	/* True when a reset happened but no sample has completed yet. */
+	bool awaiting_first_sample{ false };
+
+	/* True if coarse frames of progressive start resolution passes should
+	 * be pushed through the render tile update callback.
+	 */
+	bool progressive_preview{ false };
+	/* Full resolution RGBA buffer coarse frames get upsampled into. */
+	std::vector<float> preview_pixels;
+
+	/* Push the current frame through the render tile update callback if
+	 * it is a coarse frame of a progressive start resolution pass.
+	 */
+	void push_preview(int sample);
+
+	/* Number of a-trous filter iterations of the denoiser, 0 disables it. */
+	int denoise_iterations{ 0 };
+	/* Scale of the color range the denoiser averages over. */
+	float denoise_strength{ 1.0f };
+	/* True to denoise after every sample instead of after the last one. */
+	bool denoise_progressive{ false };
+	/* Last denoised Combined frame, RGBA. */
+	std::vector<float> denoised_pixels;
+	/* Sample denoised_pixels were made from, -1 if none since last reset. */
+	int denoised_sample{ -1 };
+	/* Seconds the last denoise took. */
+	double denoise_time{ -1.0 };
+
+	/* Denoise the current Combined frame, guided by Normal and DiffCol
+	 * passes when they are rendered, and push the result through the render
+	 * tile update callback. Returns false if there is no full resolution
+	 * Combined frame yet.
+	 */
+	bool denoise(int sample);
+	/* Denoise if enabled and due after given sample. */
+	void denoise_after_sample(int sample);
+
+	/* Retained full frame RGBA buffers per pass type. Region renders get
+	 * composited into these, see cycles_session_get_composited_buffer.
+	 */
+	std::map<int, std::vector<float>> retained_frames;
+
+	/* Record start of reset-to-first-pixel measurement. */
+	void mark_reset();
+	/* Finish reset-to-first-pixel measurement, if one is pending. */
+	void mark_sample_done();
+
+	/* Seconds spent in sampling since the last reset. */
+	double busy_time{ 0.0 };
+	/* Pixel samples rendered since the last reset. */
+	double pixel_samples{ 0.0 };
+	/* Pixel samples per second of earlier renders, 0 if never measured.
+	 * Carried over resets so a new frame can be balanced on it.
+	 */
+	double throughput{ 0.0 };
+
+	/* Account a completed sample that took seconds to render. */
+	void mark_sample_time(double seconds);
+	/* Best known pixel samples per second, 0 if never measured. */
+	double measured_throughput();
 
 	/* Create a new CCSession, initialise all necessary memory. */
 	static CCSession* create(int width, int height, unsigned int buffer_stride);
@@ -200,6 +278,58 @@ protected:
 	{  }
 };
 
+/* Process-wide scheduler for cycles_session_sample calls of all sessions.
+ *
+ * When max_concurrent is 0 (default) the scheduler lets every sample run
+ * immediately. Otherwise at most max_concurrent sessions sample at the
+ * same time. A session with a higher priority is always served before
+ * sessions with lower priority, sessions with equal priority share the
+ * slots in proportion to their weight (stride scheduling). Preemption
+ * happens at sample granularity.
+ */
+class CCRenderScheduler final {
+public:
+	/* Maximum sessions sampling at the same time, 0 disables scheduling. */
+	void set_max_concurrent(unsigned int max_concurrent);
+	/* Cap for render threads of newly created sessions, 0 means no cap. */
+	void set_max_threads(unsigned int max_threads);
+	unsigned int get_max_threads();
+
+	void add_session(unsigned int session_id);
+	void remove_session(unsigned int session_id);
+	void set_priority(unsigned int session_id, int priority);
+	void set_weight(unsigned int session_id, float weight);
+
+	/* Block until session_id is allowed to sample. */
+	void acquire(unsigned int session_id);
+	/* Signal session_id finished its sample. */
+	void release(unsigned int session_id);
+
+private:
+	struct Entry {
+		int priority{ 0 };
+		float weight{ 1.0f };
+		/* Virtual time, advances by 1/weight per sample. */
+		double pass{ 0.0 };
+		bool waiting{ false };
+		bool running{ false };
+	};
+
+	/* True if session_id is the waiting session to serve next. */
+	bool is_next(unsigned int session_id);
+
+	std::map<unsigned int, Entry> entries;
+	unsigned int max_concurrent{ 0 };
+	unsigned int max_threads{ 0 };
+	unsigned int running{ 0 };
+	double global_pass{ 0.0 };
+
+	ccl::thread_mutex mutex;
+	ccl::thread_condition_variable cond;
+};
+
+extern CCRenderScheduler render_scheduler;
+
 class CCShader {
 public:
 	/* Hold the Cycles shader. */
@@ -223,8 +353,19 @@ public:
 
 	std::vector<CCImage*> images;
 
+	/* Number of times images were tagged for reloading after their pixels
+	 * were set. Setting identical pixels again doesn't count.
+	 */
+	unsigned int image_reloads{ 0 };
+
 	std::vector<CCShader*> shaders;
 
+	/* Clipping planes by id as handed out to the client. Discarded planes
+	 * keep their slot with all components FLT_MAX, only the others go to
+	 * the Cycles scene.
+	 */
+	std::vector<ccl::float4> clipping_plane_slots;
+
 	/* Note: depth>1 if volumetric texture (i.e smoke volume data) */
 
 	void builtin_image_info(const std::string& builtin_name, void* builtin_data, ccl::ImageMetaData& meta); // bool& is_float, int& width, int& height, int& depth, int& channels);
@@ -271,9 +412,17 @@ extern bool scene_find(unsigned int scid, CCScene** csce, ccl::Scene** sce);
 extern bool session_find(unsigned int sid, CCSession** ccsess, ccl::Session** session);
 extern void scene_clear_pointer(ccl::Scene* sce);
 extern void set_ccscene_null(unsigned int scene_id);
+/* Interned ustring for name. Names seen before on the calling thread come
+ * from a per thread cache, without locking the ustring table or allocating.
+ * This always interns name, so use it only for names that are kept, not to
+ * look up names that may not exist. A null name gives the empty ustring.
+ */
+extern ccl::ustring cached_ustring(const char* name);
+extern ccl::ustring cached_ustring(const std::string& name);
 
 extern void _cleanup_scenes();
 extern void _cleanup_sessions();
+extern void _exr_session_release(unsigned int session_id);
 extern void _init_shaders(unsigned int client_id, unsigned int scene_id);
 
 /********************************/
@@ -223,7 +223,7 @@ void cycles_mesh_set_uvs(unsigned int client_id, unsigned int scene_id, unsigned
 	if(scene_find(scene_id, &csce, &sce)) {
 		ccl::Mesh* me = sce->meshes[mesh_id];
 
-		ccl::ustring uvmap = uvmap_name ? ccl::ustring(uvmap_name) : ccl::ustring("uvmap1");
+		ccl::ustring uvmap = cached_ustring(uvmap_name ? uvmap_name : "uvmap1");
 
 		ccl::Attribute* attr = me->attributes.add(ccl::ATTR_STD_UV, uvmap);
 		ccl::float2* fdata = attr->data_float2();
@@ -268,7 +268,7 @@ void cycles_mesh_set_vertex_colors(unsigned int client_id, unsigned int scene_id
 	if(scene_find(scene_id, &csce, &sce)) {
 		ccl::Mesh* me = sce->meshes[mesh_id];
 
-		ccl::Attribute *attr = me->attributes.add(ustring("vertexcolor"),
+		ccl::Attribute *attr = me->attributes.add(cached_ustring("vertexcolor"),
                                              ccl::TypeRGBA,
                                              ccl::ATTR_ELEMENT_CORNER_BYTE);
 
@@ -411,7 +411,7 @@ static void mikk_compute_tangents(ccl::Mesh *mesh, ustring uvmap_name)
 	/* Create tangent attributes. */
 	ccl::AttributeSet& attributes = mesh->attributes;
 	ccl::Attribute *attr;
-	ustring name = ustring(std::string(uvmap_name.c_str()) + std::string(".tangent"));
+	ustring name = cached_ustring(uvmap_name.string() + ".tangent");
 	auto uvattr = attributes.find(ccl::ATTR_STD_UV);
 	attr = attributes.add(ccl::ATTR_STD_UV_TANGENT, name);
 
@@ -419,7 +419,7 @@ static void mikk_compute_tangents(ccl::Mesh *mesh, ustring uvmap_name)
 	/* Create bitangent sign attribute. */
 	float *tangent_sign = NULL;
 	ccl::Attribute *attr_sign;
-	ustring name_sign = ustring(std::string(uvmap_name.c_str()) + std::string(".tangent_sign"));
+	ustring name_sign = cached_ustring(uvmap_name.string() + ".tangent_sign");
 
 	attr_sign = attributes.add(ccl::ATTR_STD_UV_TANGENT_SIGN, name_sign);
 	tangent_sign = attr_sign->data_float();
@@ -449,7 +449,7 @@ void cycles_mesh_attr_tangentspace(unsigned int client_id, unsigned int scene_id
 	ccl::Scene* sce = nullptr;
 	if(scene_find(scene_id, &csce, &sce)) {
 		ccl::Mesh* me = sce->meshes[mesh_id];
-		mikk_compute_tangents(me, ccl::ustring(uvmap_name));
+		mikk_compute_tangents(me, cached_ustring(uvmap_name));
 	}
 }
 
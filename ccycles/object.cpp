@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "internal_types.h"
 
+#include <set>
+
 unsigned int cycles_scene_add_object(unsigned int client_id, unsigned int scene_id)
 {
 	CCScene* csce = nullptr;
@@ -143,6 +145,283 @@ void cycles_scene_object_set_is_block_instance(unsigned int client, unsigned int
 	}
 }
 
+unsigned int cycles_scene_add_object_instances(unsigned int client_id, unsigned int scene_id, unsigned int mesh_id, unsigned int count,
+	const float* transforms, const int* pass_ids, const unsigned int* random_ids, const unsigned int* shader_ids)
+{
+	CCScene* csce = nullptr;
+	ccl::Scene* sce = nullptr;
+	if (!scene_find(scene_id, &csce, &sce) || mesh_id >= sce->meshes.size() || count == 0) return UINT_MAX;
+
+	ccl::Mesh* me = sce->meshes[mesh_id];
+	const unsigned int first = (unsigned int)sce->objects.size();
+	sce->objects.reserve(sce->objects.size() + count);
+
+	/* Shader overrides usually repeat, look each id up only once. */
+	std::map<unsigned int, ccl::Shader*> shader_lookup;
+	std::set<ccl::Shader*> used_shaders;
+
+	for (unsigned int i = 0; i < count; i++) {
+		ccl::Object* ob = new ccl::Object();
+		ob->mesh = me;
+		if (transforms) {
+			const float* t = transforms + (size_t)i * 12;
+			ob->tfm = ccl::make_transform(t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7], t[8], t[9], t[10], t[11]);
+		}
+		else {
+			ob->tfm = ccl::transform_identity();
+		}
+		/* Keep the mesh in object space even while it has a single user,
+		 * so its BVH gets built once and referenced by every instance.
+		 */
+		ob->is_block_instance = true;
+		if (pass_ids) ob->pass_id = pass_ids[i];
+		if (random_ids) ob->random_id = random_ids[i];
+		if (shader_ids && shader_ids[i] != UINT_MAX) {
+			auto it = shader_lookup.find(shader_ids[i]);
+			if (it == shader_lookup.end()) {
+				it = shader_lookup.emplace(shader_ids[i], find_shader_in_scene(sce, shader_ids[i])).first;
+				if (!it->second) {
+					logger.logit(client_id, "Shader ", shader_ids[i], " not found in scene ", scene_id, ", instances using it keep the mesh shaders");
+				}
+			}
+			if (it->second) {
+				ob->shader = it->second;
+				used_shaders.insert(it->second);
+			}
+		}
+		sce->objects.push_back(ob);
+	}
+
+	for (ccl::Shader* sh : used_shaders) {
+		sh->tag_update(sce);
+		sh->tag_used(sce);
+	}
+
+	/* All instances share the mesh, tagging one of them flags the
+	 * managers for all.
+	 */
+	sce->objects[first]->tag_update(sce);
+	sce->light_manager->tag_update(sce);
+
+	logger.logit(client_id, "Added ", count, " instances of mesh ", mesh_id, " as objects ", first, "-", first + count - 1, " to scene ", scene_id);
+
+	return first;
+}
+
+unsigned int cycles_scene_object_count(unsigned int client_id, unsigned int scene_id)
+{
+	CCScene* csce = nullptr;
+	ccl::Scene* sce = nullptr;
+	if (scene_find(scene_id, &csce, &sce)) {
+		return (unsigned int)sce->objects.size();
+	}
+	return 0;
+}
+
+void cycles_scene_object_instances_set_matrices(unsigned int client_id, unsigned int scene_id, unsigned int first_object_id, unsigned int count, const float* transforms)
+{
+	CCScene* csce = nullptr;
+	ccl::Scene* sce = nullptr;
+	if (!scene_find(scene_id, &csce, &sce) || transforms == nullptr || count == 0 || (size_t)first_object_id + count > sce->objects.size()) return;
+
+	for (unsigned int i = 0; i < count; i++) {
+		const float* t = transforms + (size_t)i * 12;
+		sce->objects[first_object_id + i]->tfm = ccl::make_transform(t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7], t[8], t[9], t[10], t[11]);
+	}
+	sce->objects[first_object_id]->tag_update(sce);
+	sce->light_manager->tag_update(sce);
+}
+
+/* True if ob emits light, through its own shader or one of its mesh
+ * shaders, as Object::tag_update checks it.
+ */
+static bool object_has_emission(const ccl::Object* ob)
+{
+	if (ob->shader && ob->shader->has_surface_emission) return true;
+	if (ob->mesh) {
+		for (const ccl::Shader* sh : ob->mesh->used_shaders) {
+			if (sh && sh->has_surface_emission) return true;
+		}
+	}
+	return false;
+}
+
+/* Undo the static transform baking of ob's mesh, which was done with
+ * transform baked. Cycles only bakes a mesh once, so without this a moved
+ * object would keep the old world space vertices. The mesh goes back to
+ * object space and gets re-baked with the new transform on the next update.
+ */
+static void object_unbake_transform(ccl::Scene* sce, ccl::Object* ob, const ccl::Transform& baked)
+{
+	const ccl::Transform tfm = ob->tfm;
+	ob->tfm = ccl::transform_inverse(baked);
+	ob->apply_transform(true);
+	ob->tfm = tfm;
+
+	ccl::Mesh* mesh = ob->mesh;
+	mesh->transform_applied = false;
+	mesh->transform_normal = ccl::transform_identity();
+	mesh->transform_negative_scaled = false;
+	mesh->tag_update(sce, true);
+}
+
+int cycles_scene_apply_frame(unsigned int client_id, unsigned int scene_id, unsigned int count, const unsigned int* object_ids,
+	const float* transforms, const unsigned int* shader_ids)
+{
+	CCScene* csce = nullptr;
+	ccl::Scene* sce = nullptr;
+	if (!scene_find(scene_id, &csce, &sce)) return -1;
+
+	std::map<unsigned int, ccl::Shader*> shader_lookup;
+	ccl::Object* tagged = nullptr;
+	bool lights_changed = false;
+	int changed = 0;
+
+	for (unsigned int i = 0; i < count; i++) {
+		const unsigned int object_id = object_ids ? object_ids[i] : i;
+		if (object_id >= sce->objects.size()) continue;
+		ccl::Object* ob = sce->objects[object_id];
+		bool ob_changed = false;
+
+		if (transforms) {
+			const float* t = transforms + (size_t)i * 12;
+			ccl::Transform tfm = ccl::make_transform(t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7], t[8], t[9], t[10], t[11]);
+			if (tfm != ob->tfm) {
+				if (ob->mesh && ob->mesh->transform_applied) {
+					object_unbake_transform(sce, ob, ob->tfm);
+				}
+				ob->tfm = tfm;
+				ob_changed = true;
+				/* Moving emissive objects changes the light distribution. */
+				if (object_has_emission(ob)) lights_changed = true;
+			}
+		}
+
+		if (shader_ids && shader_ids[i] != UINT_MAX) {
+			auto it = shader_lookup.find(shader_ids[i]);
+			if (it == shader_lookup.end()) {
+				it = shader_lookup.emplace(shader_ids[i], find_shader_in_scene(sce, shader_ids[i])).first;
+				if (!it->second) {
+					logger.logit(client_id, "Shader ", shader_ids[i], " not found in scene ", scene_id, ", object ", object_id, " keeps its shader");
+				}
+			}
+			if (it->second && it->second != ob->shader) {
+				ob->shader = it->second;
+				it->second->tag_update(sce);
+				it->second->tag_used(sce);
+				lights_changed = true;
+				ob_changed = true;
+			}
+		}
+
+		if (!ob_changed) continue;
+		changed++;
+
+		/* Meshes un-baked above are already tagged for re-upload, every
+		 * other object only needs its object data re-uploaded, for which one
+		 * tagged object suffices.
+		 */
+		if (!tagged) {
+			tagged = ob;
+			ob->tag_update(sce);
+		}
+	}
+
+	if (lights_changed) {
+		sce->light_manager->tag_update(sce);
+	}
+
+	logger.logit(client_id, "Applied frame to scene ", scene_id, ", ", changed, " of ", count, " objects changed");
+
+	return changed;
+}
+
+int cycles_scene_objects_set_properties(unsigned int client_id, unsigned int scene_id, unsigned int count, const unsigned int* object_ids,
+	const unsigned int* visibility, const unsigned int* shader_ids, const int* pass_ids, const unsigned int* random_ids,
+	const bool* is_shadowcatcher, const bool* mesh_light_no_cast_shadow, const bool* is_block_instance)
+{
+	CCScene* csce = nullptr;
+	ccl::Scene* sce = nullptr;
+	if (!scene_find(scene_id, &csce, &sce)) return -1;
+
+	/* Validate everything up front, so a bad id leaves the scene untouched.
+	 * Shaders get looked up once per distinct id on the way.
+	 */
+	std::map<unsigned int, ccl::Shader*> shader_lookup;
+	for (unsigned int i = 0; i < count; i++) {
+		const unsigned int object_id = object_ids ? object_ids[i] : i;
+		if (object_id >= sce->objects.size()) return -2;
+		if (shader_ids && shader_ids[i] != UINT_MAX && shader_lookup.find(shader_ids[i]) == shader_lookup.end()) {
+			ccl::Shader* sh = find_shader_in_scene(sce, shader_ids[i]);
+			if (!sh) return -2;
+			shader_lookup.emplace(shader_ids[i], sh);
+		}
+	}
+
+	std::set<ccl::Shader*> used_shaders;
+	ccl::Object* tagged = nullptr;
+
+	for (unsigned int i = 0; i < count; i++) {
+		ccl::Object* ob = sce->objects[object_ids ? object_ids[i] : i];
+		if (visibility) ob->visibility = visibility[i];
+		if (shader_ids && shader_ids[i] != UINT_MAX) {
+			ob->shader = shader_lookup[shader_ids[i]];
+			used_shaders.insert(ob->shader);
+		}
+		if (pass_ids) ob->pass_id = pass_ids[i];
+		if (random_ids) ob->random_id = random_ids[i];
+		if (is_shadowcatcher) ob->is_shadow_catcher = is_shadowcatcher[i];
+		if (mesh_light_no_cast_shadow) ob->mesh_light_no_cast_shadow = mesh_light_no_cast_shadow[i];
+		/* Switching between baked and instanced changes the mesh data, so
+		 * these objects need their own tag.
+		 */
+		if (is_block_instance && ob->is_block_instance != is_block_instance[i]) {
+			ob->is_block_instance = is_block_instance[i];
+			ob->tag_update(sce);
+		}
+		if (!tagged) tagged = ob;
+	}
+
+	for (ccl::Shader* sh : used_shaders) {
+		sh->tag_update(sce);
+		sh->tag_used(sce);
+	}
+
+	/* Remaining changes are object data only, one tag flags the managers. */
+	if (tagged) {
+		tagged->tag_update(sce);
+		sce->light_manager->tag_update(sce);
+	}
+
+	logger.logit(client_id, "Set properties of ", count, " objects in scene ", scene_id);
+
+	return (int)count;
+}
+
+int cycles_scene_object_set_motion(unsigned int client_id, unsigned int scene_id, unsigned int object_id, unsigned int steps, const float* transforms)
+{
+	CCScene* csce = nullptr;
+	ccl::Scene* sce = nullptr;
+	if (!scene_find(scene_id, &csce, &sce) || object_id >= sce->objects.size()) return -1;
+	/* Cycles puts the object transform at the center of the shutter. */
+	if (steps > 1 && (steps % 2 == 0 || transforms == nullptr)) return -2;
+
+	ccl::Object* ob = sce->objects[object_id];
+	ob->motion.clear();
+	if (steps > 1) {
+		ob->motion.resize(steps);
+		for (unsigned int s = 0; s < steps; s++) {
+			const float* t = transforms + (size_t)s * 12;
+			ob->motion[s] = ccl::make_transform(t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7], t[8], t[9], t[10], t[11]);
+		}
+		ob->tfm = ob->motion[steps / 2];
+	}
+	ob->tag_update(sce);
+
+	logger.logit(client_id, "Set ", steps, " motion steps on object ", object_id, " in scene ", scene_id);
+	return 0;
+}
+
 void cycles_scene_object_set_cutout(unsigned int client, unsigned int scene_id, unsigned int object_id, bool cutout)
 {
 	/*CCScene* csce = nullptr;
@@ -234,13 +513,43 @@ void cycles_object_set_random_id(unsigned int client_id, unsigned int scene_id,
 	}
 }
 
+static bool clipping_plane_active(const ccl::float4& cp)
+{
+	return !(cp.x == FLT_MAX && cp.y == FLT_MAX && cp.z == FLT_MAX && cp.w == FLT_MAX);
+}
+
+/* Hand the active clipping planes to the Cycles scene. Every plane in the
+ * scene gets tested for every hit, so discarded planes are left out. Only
+ * tags the clipping plane update, and only if the planes actually changed.
+ */
+static void clipping_planes_sync(CCScene* csce, ccl::Scene* sce)
+{
+	std::vector<ccl::float4> active;
+	for (const ccl::float4& cp : csce->clipping_plane_slots) {
+		if (clipping_plane_active(cp)) active.push_back(cp);
+	}
+
+	bool changed = active.size() != sce->clipping_planes.size();
+	for (size_t i = 0; !changed && i < active.size(); i++) {
+		const ccl::float4& a = active[i];
+		const ccl::float4& b = sce->clipping_planes[i];
+		changed = a.x != b.x || a.y != b.y || a.z != b.z || a.w != b.w;
+	}
+
+	if (changed) {
+		sce->clipping_planes.clear();
+		for (const ccl::float4& cp : active) sce->clipping_planes.push_back(cp);
+		sce->object_manager->need_clipping_plane_update = true;
+	}
+}
+
 void cycles_scene_clear_clipping_planes(unsigned int client_id, unsigned int scene_id)
 {
 	CCScene* csce = nullptr;
 	ccl::Scene* sce = nullptr;
 	if(scene_find(scene_id, &csce, &sce)) {
-		sce->clipping_planes.clear();
-		sce->object_manager->need_clipping_plane_update = true;
+		csce->clipping_plane_slots.clear();
+		clipping_planes_sync(csce, sce);
 	}
 }
 
@@ -250,13 +559,13 @@ unsigned int cycles_scene_add_clipping_plane(unsigned int client_id, unsigned in
 	ccl::Scene* sce = nullptr;
 	if(scene_find(scene_id, &csce, &sce)) {
 		ccl::float4 cp = ccl::make_float4(a, b, c, d);
-		sce->clipping_planes.push_back(cp);
+		csce->clipping_plane_slots.push_back(cp);
 
-		logger.logit(client_id, "Added clipping plane ", sce->clipping_planes.size() - 1, " to scene ", scene_id);
+		logger.logit(client_id, "Added clipping plane ", csce->clipping_plane_slots.size() - 1, " to scene ", scene_id);
 
-		sce->object_manager->need_clipping_plane_update = true;
+		clipping_planes_sync(csce, sce);
 
-		return (unsigned int)(sce->clipping_planes.size() - 1);
+		return (unsigned int)(csce->clipping_plane_slots.size() - 1);
 	}
 
 	return UINT_MAX;
@@ -272,11 +581,13 @@ void cycles_scene_set_clipping_plane(unsigned int client_id, unsigned int scene_
 	CCScene* csce = nullptr;
 	ccl::Scene* sce = nullptr;
 	if(scene_find(scene_id, &csce, &sce)) {
+		if (cp_id >= csce->clipping_plane_slots.size()) return;
+
 		ccl::float4 cp = ccl::make_float4(a, b, c, d);
-		sce->clipping_planes[cp_id] = cp;
+		csce->clipping_plane_slots[cp_id] = cp;
 
-		logger.logit(client_id, "Setting clipping plane ", sce->clipping_planes.size() - 1, " to scene ", scene_id);
+		logger.logit(client_id, "Setting clipping plane ", cp_id, " to scene ", scene_id);
 
-		sce->object_manager->need_clipping_plane_update = true;
+		clipping_planes_sync(csce, sce);
 	}
 }
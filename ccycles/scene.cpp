@@ -240,3 +240,19 @@ void cycles_scene_unlock(unsigned int client_id, unsigned int scene_id)
 	}
 }
 
+unsigned int cycles_scene_get_update_flags(unsigned int client_id, unsigned int scene_id)
+{
+	CCScene* csce = nullptr;
+	ccl::Scene* sce = nullptr;
+	unsigned int flags = (unsigned int)scene_update_flags::NONE;
+	if(scene_find(scene_id, &csce, &sce)) {
+		if (sce->object_manager->need_update) flags |= (unsigned int)scene_update_flags::OBJECTS;
+		if (sce->mesh_manager->need_update) flags |= (unsigned int)scene_update_flags::MESHES;
+		if (sce->camera->need_update) flags |= (unsigned int)scene_update_flags::CAMERA;
+		if (sce->integrator->need_update) flags |= (unsigned int)scene_update_flags::INTEGRATOR;
+		if (sce->light_manager->need_update) flags |= (unsigned int)scene_update_flags::LIGHTS;
+		if (sce->image_manager->need_update) flags |= (unsigned int)scene_update_flags::IMAGES;
+	}
+	return flags;
+}
+
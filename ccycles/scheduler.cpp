@@ -0,0 +1,232 @@
+/**
+Copyright 2014-2017 Robert McNeel and Associates
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**/
+
+#include "internal_types.h"
+
+/* The one scheduler shared by all sessions in this process. */
+CCRenderScheduler render_scheduler;
+
+void CCRenderScheduler::set_max_concurrent(unsigned int max_concurrent_)
+{
+	ccl::thread_scoped_lock lock(mutex);
+	max_concurrent = max_concurrent_;
+	cond.notify_all();
+}
+
+void CCRenderScheduler::set_max_threads(unsigned int max_threads_)
+{
+	ccl::thread_scoped_lock lock(mutex);
+	max_threads = max_threads_;
+}
+
+unsigned int CCRenderScheduler::get_max_threads()
+{
+	ccl::thread_scoped_lock lock(mutex);
+	return max_threads;
+}
+
+void CCRenderScheduler::add_session(unsigned int session_id)
+{
+	ccl::thread_scoped_lock lock(mutex);
+	Entry e;
+	/* Start at current virtual time so a new session doesn't get to
+	 * catch up on all samples done before it existed.
+	 */
+	e.pass = global_pass;
+	entries[session_id] = e;
+}
+
+void CCRenderScheduler::remove_session(unsigned int session_id)
+{
+	ccl::thread_scoped_lock lock(mutex);
+	auto it = entries.find(session_id);
+	if (it == entries.end()) return;
+	if (it->second.running) running--;
+	entries.erase(it);
+	cond.notify_all();
+}
+
+void CCRenderScheduler::set_priority(unsigned int session_id, int priority)
+{
+	ccl::thread_scoped_lock lock(mutex);
+	auto it = entries.find(session_id);
+	if (it == entries.end()) return;
+	it->second.priority = priority;
+	cond.notify_all();
+}
+
+void CCRenderScheduler::set_weight(unsigned int session_id, float weight)
+{
+	ccl::thread_scoped_lock lock(mutex);
+	auto it = entries.find(session_id);
+	if (it == entries.end()) return;
+	it->second.weight = weight > 0.0f ? weight : 1.0f;
+	cond.notify_all();
+}
+
+bool CCRenderScheduler::is_next(unsigned int session_id)
+{
+	const Entry& e = entries[session_id];
+	for (auto& other : entries) {
+		if (other.first == session_id) continue;
+		const Entry& o = other.second;
+		/* Higher priority sessions that are active hold off lower ones. */
+		if (o.priority > e.priority && (o.waiting || o.running)) return false;
+		if (!o.waiting || o.priority != e.priority) continue;
+		if (o.pass < e.pass) return false;
+		if (o.pass == e.pass && other.first < session_id) return false;
+	}
+	return true;
+}
+
+void CCRenderScheduler::acquire(unsigned int session_id)
+{
+	ccl::thread_scoped_lock lock(mutex);
+	auto it = entries.find(session_id);
+	if (max_concurrent == 0 || it == entries.end()) return;
+
+	it->second.waiting = true;
+	cond.wait(lock, [&] {
+		/* Stop waiting if scheduling got switched off or session removed. */
+		if (max_concurrent == 0 || entries.find(session_id) == entries.end()) return true;
+		return running < max_concurrent && is_next(session_id);
+	});
+
+	it = entries.find(session_id);
+	if (it == entries.end()) return;
+	it->second.waiting = false;
+	/* With this session out of the waiting set another one may now be
+	 * next, and with more than one slot there may be one left for it.
+	 */
+	cond.notify_all();
+	if (max_concurrent == 0) return;
+
+	it->second.running = true;
+	running++;
+	global_pass = it->second.pass;
+}
+
+void CCRenderScheduler::release(unsigned int session_id)
+{
+	ccl::thread_scoped_lock lock(mutex);
+	auto it = entries.find(session_id);
+	if (it == entries.end() || !it->second.running) return;
+
+	it->second.running = false;
+	it->second.pass += 1.0 / it->second.weight;
+	running--;
+	cond.notify_all();
+}
+
+void cycles_scheduler_set_max_concurrent(unsigned int client_id, unsigned int max_concurrent)
+{
+	render_scheduler.set_max_concurrent(max_concurrent);
+	logger.logit(client_id, "Set render scheduler max concurrent sessions to ", max_concurrent);
+}
+
+void cycles_scheduler_set_max_threads(unsigned int client_id, unsigned int max_threads)
+{
+	render_scheduler.set_max_threads(max_threads);
+	logger.logit(client_id, "Set render scheduler max threads to ", max_threads);
+}
+
+void cycles_session_set_priority(unsigned int client_id, unsigned int session_id, int priority)
+{
+	render_scheduler.set_priority(session_id, priority);
+	logger.logit(client_id, "Set session ", session_id, " priority to ", priority);
+}
+
+void cycles_session_set_weight(unsigned int client_id, unsigned int session_id, float weight)
+{
+	render_scheduler.set_weight(session_id, weight);
+	logger.logit(client_id, "Set session ", session_id, " weight to ", weight);
+}
+
+void cycles_session_get_throughput(unsigned int client_id, unsigned int session_id, double* pixel_samples_per_second, double* utilization)
+{
+	*pixel_samples_per_second = 0.0;
+	*utilization = 0.0;
+
+	CCSession* ccsess = nullptr;
+	ccl::Session* session = nullptr;
+	if (session_find(session_id, &ccsess, &session)) {
+		*pixel_samples_per_second = ccsess->measured_throughput();
+		std::chrono::duration<double> wall = std::chrono::steady_clock::now() - ccsess->reset_time;
+		if (wall.count() > 0.0) {
+			*utilization = ccl::min(ccsess->busy_time / wall.count(), 1.0);
+		}
+	}
+}
+
+int cycles_session_group_balance(unsigned int client_id, unsigned int count, const unsigned int* session_ids, unsigned int samples)
+{
+	if (count == 0 || session_ids == nullptr) return -2;
+
+	std::vector<double> rates(count, 0.0);
+	int full_width = 0;
+	int full_height = 0;
+	double known_sum = 0.0;
+	unsigned int known = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		CCSession* ccsess = nullptr;
+		ccl::Session* session = nullptr;
+		if (!session_find(session_ids[i], &ccsess, &session)) return -1;
+
+		const ccl::BufferParams& bp = ccsess->full_buffer_params;
+		if (i == 0) {
+			full_width = bp.width;
+			full_height = bp.height;
+		}
+		/* All sessions have to render the same full frame. */
+		if (bp.width != full_width || bp.height != full_height) return -2;
+
+		rates[i] = ccsess->measured_throughput();
+		if (rates[i] > 0.0) {
+			known_sum += rates[i];
+			known++;
+		}
+	}
+	if (full_width <= 0 || full_height < (int)count) return -2;
+
+	/* Sessions not measured yet get the average of the others, or all an
+	 * equal share on the first frame.
+	 */
+	double fallback = known > 0 ? known_sum / known : 1.0;
+	double total = 0.0;
+	for (double& rate : rates) {
+		if (rate <= 0.0) rate = fallback;
+		total += rate;
+	}
+
+	/* Stack bands top to bottom, rounding the cumulative share so the bands
+	 * cover the frame exactly and every session keeps at least one row.
+	 */
+	int y = 0;
+	double acc = 0.0;
+	for (unsigned int i = 0; i < count; i++) {
+		acc += rates[i];
+		int y1 = i == count - 1 ? full_height : (int)(full_height * acc / total + 0.5);
+		y1 = ccl::clamp(y1, y + 1, full_height - (int)(count - 1 - i));
+
+		int rc = cycles_session_reset_region(client_id, session_ids[i], 0, (unsigned int)y, (unsigned int)full_width, (unsigned int)(y1 - y), samples);
+		if (rc != 0) return rc;
+
+		logger.logit(client_id, "Balanced session ", session_ids[i], " to rows ", y, "-", y1 - 1, " at ", rates[i], " pixel samples/s");
+		y = y1;
+	}
+
+	return 0;
+}
@@ -42,6 +42,13 @@ std::vector<ccl::vector<ccl::Pass>*> passes_vec;
 
 static ccl::thread_mutex session_mutex;
 
+/* Pool of idle ccl::Sessions kept alive after cycles_session_destroy, so
+ * new sessions with the same parameters can reuse device, loaded kernels
+ * and buffers. Guarded by session_mutex.
+ */
+static std::vector<ccl::Session*> session_pool;
+static unsigned int session_pool_capacity{ 0 };
+
 class CyclesRenderCrashException : std::exception
 {
 public:
@@ -148,11 +155,152 @@ void CCSession::display_update(int sample)
 	}
 }
 
+/* Take a pooled ccl::Session created with params equal to given params.
+ * Returns nullptr if none is available. Caller holds session_mutex.
+ */
+static ccl::Session* session_pool_take(const ccl::SessionParams& params)
+{
+	for (auto it = session_pool.begin(); it != session_pool.end(); ++it) {
+		ccl::Session* pooled = *it;
+		if (!pooled->params.modified(params)) {
+			session_pool.erase(it);
+			return pooled;
+		}
+	}
+	return nullptr;
+}
+
+/* Stop session so it can go into the pool: cancel and wait for the render
+ * thread, and release all client callbacks. Waiting can take as long as
+ * the cancel does, so the caller must not hold session_mutex.
+ */
+static void session_pool_prepare(ccl::Session* session)
+{
+	session->progress.set_cancel("Returning session to pool");
+	session->wait();
+
+	session->progress.set_update_callback(nullptr);
+	session->progress.set_cancel_callback(nullptr);
+	session->update_render_tile_cb = nullptr;
+	session->progress.reset();
+}
+
+/* Park a session prepared with session_pool_prepare in the pool if there is
+ * room. The scene is released, device and buffers are kept. Returns true if
+ * the session was pooled. Caller holds session_mutex.
+ */
+static bool session_pool_put(ccl::Session* session)
+{
+	if (session_pool.size() >= session_pool_capacity) return false;
+
+	delete session->scene;
+	session->scene = nullptr;
+
+	session_pool.push_back(session);
+	return true;
+}
+
+/* Free pooled sessions until at most keep are left. Caller holds session_mutex. */
+static void session_pool_trim(size_t keep)
+{
+	while (session_pool.size() > keep) {
+		delete session_pool.back();
+		session_pool.pop_back();
+	}
+}
+
+/* Upsample a coarse RGBA frame of cw*ch pixels to w*h pixels. Bilinear
+ * weights are scaled down for coarse pixels that differ in luminance from
+ * the coarse pixel covering the target pixel, so edges stay crisp instead
+ * of being smeared over divider pixels.
+ */
+static void upsample_edge_aware(const float* coarse, int cw, int ch, float* out, int w, int h)
+{
+	const float range = 4.0f;
+	auto lum = [](const float* p) { return 0.2126f * p[0] + 0.7152f * p[1] + 0.0722f * p[2]; };
+
+	const float sx = (float)cw / (float)w;
+	const float sy = (float)ch / (float)h;
+
+	for (int y = 0; y < h; y++) {
+		float fy = ((float)y + 0.5f) * sy - 0.5f;
+		int y0 = ccl::clamp((int)floorf(fy), 0, ch - 1);
+		int y1 = ccl::min(y0 + 1, ch - 1);
+		float ty = ccl::clamp(fy - (float)y0, 0.0f, 1.0f);
+		int yn = ccl::clamp((int)(((float)y + 0.5f) * sy), 0, ch - 1);
+
+		for (int x = 0; x < w; x++) {
+			float fx = ((float)x + 0.5f) * sx - 0.5f;
+			int x0 = ccl::clamp((int)floorf(fx), 0, cw - 1);
+			int x1 = ccl::min(x0 + 1, cw - 1);
+			float tx = ccl::clamp(fx - (float)x0, 0.0f, 1.0f);
+			int xn = ccl::clamp((int)(((float)x + 0.5f) * sx), 0, cw - 1);
+
+			float guide = lum(&coarse[(yn * cw + xn) * 4]);
+			const int xs[4] = { x0, x1, x0, x1 };
+			const int ys[4] = { y0, y0, y1, y1 };
+			const float bw[4] = { (1.0f - tx) * (1.0f - ty), tx * (1.0f - ty), (1.0f - tx) * ty, tx * ty };
+
+			float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float wsum = 0.0f;
+			for (int i = 0; i < 4; i++) {
+				const float* c = &coarse[(ys[i] * cw + xs[i]) * 4];
+				float d = (lum(c) - guide) / (fabsf(guide) + 1e-2f);
+				float wi = bw[i] / (1.0f + range * d * d);
+				acc[0] += wi * c[0];
+				acc[1] += wi * c[1];
+				acc[2] += wi * c[2];
+				acc[3] += wi * c[3];
+				wsum += wi;
+			}
+
+			float* o = &out[((size_t)y * w + x) * 4];
+			float inv = wsum > 0.0f ? 1.0f / wsum : 0.0f;
+			o[0] = acc[0] * inv;
+			o[1] = acc[1] * inv;
+			o[2] = acc[2] * inv;
+			o[3] = acc[3] * inv;
+		}
+	}
+}
+
+void CCSession::push_preview(int sample)
+{
+	if (!progressive_preview || update_cbs[id] == nullptr) return;
+
+	int divider = session->tile_manager.state.resolution_divider;
+	if (divider <= 1) return;
+
+	ccl::DisplayBuffer* db = session->display_buffers[ccl::PassType::PASS_COMBINED];
+	if (db == nullptr) return;
+
+	ccl::DeviceDrawParams draw_params = ccl::DeviceDrawParams();
+	draw_params.bind_display_space_shader_cb = nullptr;
+	draw_params.unbind_display_space_shader_cb = nullptr;
+
+	float* coarse = (float*)db->prepare_pixels(session->device, draw_params);
+	int cw = db->draw_width;
+	int ch = db->draw_height;
+	int w = buffer_params.width;
+	int h = buffer_params.height;
+	if (coarse == nullptr || cw <= 0 || ch <= 0 || w <= 0 || h <= 0) return;
+
+	preview_pixels.resize((size_t)w * h * 4);
+	upsample_edge_aware(coarse, cw, ch, preview_pixels.data(), w, h);
+
+	update_cbs[id](id, 0, 0, w, h, sample, 4, ccl::PassType::PASS_COMBINED, preview_pixels.data(), (int)preview_pixels.size());
+}
+
 /**
  * Clean up resources acquired during this run of Cycles.
  */
 void _cleanup_sessions()
 {
+	{
+		ccl::thread_scoped_lock lock(session_mutex);
+		session_pool_trim(0);
+	}
+
 	for (CCSession* se : sessions) {
 		if (se == nullptr) continue;
 
@@ -188,6 +336,47 @@ bool CCSession::size_has_changed() {
 	return rc;
 }
 
+void CCSession::mark_reset() {
+	reset_time = std::chrono::steady_clock::now();
+	reset_latency = -1.0;
+	awaiting_first_sample = true;
+	denoised_sample = -1;
+
+	/* Fold the finished measurement into the running throughput, averaged
+	 * with earlier ones so a single odd frame doesn't swing it too far.
+	 */
+	if (busy_time > 0.0 && pixel_samples > 0.0) {
+		double rate = pixel_samples / busy_time;
+		throughput = throughput > 0.0 ? 0.5 * (throughput + rate) : rate;
+	}
+	busy_time = 0.0;
+	pixel_samples = 0.0;
+}
+
+void CCSession::mark_sample_done() {
+	if (!awaiting_first_sample) return;
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - reset_time;
+	reset_latency = elapsed.count();
+	awaiting_first_sample = false;
+}
+
+void CCSession::mark_sample_time(double seconds) {
+	/* Coarse start resolution passes render only every divider-th pixel. */
+	int divider = ccl::max(session->tile_manager.state.resolution_divider, 1);
+	int w = ccl::max(buffer_params.width / divider, 1);
+	int h = ccl::max(buffer_params.height / divider, 1);
+	busy_time += seconds;
+	pixel_samples += (double)w * h;
+}
+
+double CCSession::measured_throughput() {
+	/* Too short a measurement is mostly overhead, prefer earlier renders. */
+	if (busy_time > 0.05 || (throughput <= 0.0 && busy_time > 0.0)) {
+		return pixel_samples / busy_time;
+	}
+	return throughput;
+}
+
 unsigned int cycles_session_create(unsigned int client_id, unsigned int session_params_id)
 {
 	ccl::thread_scoped_lock lock(session_mutex);
@@ -199,8 +388,21 @@ unsigned int cycles_session_create(unsigned int client_id, unsigned int session_
 	int csesid{ -1 };
 	int hid{ 0 };
 
+	/* Keep render threads within the process-wide cap, if one is set. */
+	ccl::SessionParams capped_params = *params;
+	unsigned int max_threads = render_scheduler.get_max_threads();
+	if (max_threads > 0 && (capped_params.threads <= 0 || capped_params.threads > (int)max_threads)) {
+		capped_params.threads = (int)max_threads;
+	}
+
 	CCSession* session = CCSession::create(10, 10, 4);
-	session->session = new ccl::Session(*params);
+	session->session = session_pool_take(capped_params);
+	if (session->session == nullptr) {
+		session->session = new ccl::Session(capped_params);
+	}
+	else {
+		logger.logit(client_id, "Reusing pooled session for session_params ", session_params_id);
+	}
 
 	for(CCSession* csess : sessions) {
 		if(csess==nullptr) {
@@ -231,6 +433,7 @@ unsigned int cycles_session_create(unsigned int client_id, unsigned int session_
 
 
 	session->id = csesid;
+	render_scheduler.add_session(session->id);
 
 	logger.logit(client_id, "Created session ", session->id, " with session_params ", session_params_id);
 
@@ -267,12 +470,58 @@ void cycles_session_destroy(unsigned int client_id, unsigned int session_id, uns
 			}
 		}
 
-		delete ccsess;
+		render_scheduler.remove_session(session_id);
+		_exr_session_release(session_id);
+
+		bool poolable = false;
+		{
+			ccl::thread_scoped_lock lock(session_mutex);
+			poolable = session_pool.size() < session_pool_capacity;
+		}
+		/* Stop rendering without holding the lock, other threads keep
+		 * finding their sessions meanwhile.
+		 */
+		if (poolable) {
+			session_pool_prepare(session);
+		}
+
+		{
+			ccl::thread_scoped_lock lock(session_mutex);
+			if (poolable && session_pool_put(session)) {
+				ccsess->session = nullptr;
+				logger.logit(client_id, "Returned session ", session_id, " to pool");
+			}
+			sessions[session_id] = nullptr;
+		}
 
-		sessions[session_id] = nullptr;
+		/* A session that didn't go into the pool waits for its render
+		 * thread when deleted, also not something to hold the lock for.
+		 */
+		delete ccsess;
 	}
 }
 
+void cycles_session_pool_set_capacity(unsigned int client_id, unsigned int capacity)
+{
+	ccl::thread_scoped_lock lock(session_mutex);
+	session_pool_capacity = capacity;
+	session_pool_trim(capacity);
+	logger.logit(client_id, "Set session pool capacity to ", capacity);
+}
+
+unsigned int cycles_session_pool_size(unsigned int client_id)
+{
+	ccl::thread_scoped_lock lock(session_mutex);
+	return (unsigned int)session_pool.size();
+}
+
+void cycles_session_pool_clear(unsigned int client_id)
+{
+	ccl::thread_scoped_lock lock(session_mutex);
+	session_pool_trim(0);
+	logger.logit(client_id, "Cleared session pool");
+}
+
 ccl::vector<ccl::Pass>& get_passes(unsigned int session_id) {
 	ccl::vector<ccl::Pass>* passes = passes_vec[session_id];
 
@@ -343,8 +592,9 @@ int cycles_session_reset(unsigned int client_id, unsigned int session_id, unsign
 			session->scene->film->tag_update(session->scene);
 
 			ccsess->buffer_params.passes = passes;
+			ccsess->full_buffer_params = ccsess->buffer_params;
 
-
+			ccsess->mark_reset();
 			session->reset(ccsess->buffer_params, (int)samples);
 		}
 		catch (CyclesRenderCrashException)
@@ -359,6 +609,117 @@ int cycles_session_reset(unsigned int client_id, unsigned int session_id, unsign
 	return rc;
 }
 
+int cycles_session_reset_region(unsigned int client_id, unsigned int session_id, unsigned int x, unsigned int y, unsigned int width, unsigned int height, unsigned int samples)
+{
+	RenderCrashTranslatorHelper render_crash_helper(render_crash_translator);
+
+	int rc = 0;
+	CCSession* ccsess = nullptr;
+	ccl::Session* session = nullptr;
+	if (session_find(session_id, &ccsess, &session)) {
+		const ccl::BufferParams& full = ccsess->full_buffer_params;
+		/* region has to lie within the frame of the last full reset. Written
+		 * so x + width can't wrap around.
+		 */
+		if (width == 0 || height == 0 || width > (unsigned int)full.width || height > (unsigned int)full.height
+			|| x > (unsigned int)full.width - width || y > (unsigned int)full.height - height) {
+			return -2;
+		}
+		try {
+			logger.logit(client_id, "Reset region of session ", session_id, " to ", x, ",", y, " ", width, "x", height, " samples ", samples);
+			ccl::BufferParams& bp = ccsess->buffer_params;
+			bp = full;
+			bp.full_x = full.full_x + (int)x;
+			bp.full_y = full.full_y + (int)y;
+			bp.width = (int)width;
+			bp.height = (int)height;
+
+			ccsess->params.samples = samples;
+
+			ccsess->mark_reset();
+			session->reset(bp, (int)samples);
+		}
+		catch (CyclesRenderCrashException)
+		{
+			rc = -13;
+		}
+		catch (...)
+		{
+			rc = -13;
+		}
+	}
+	else {
+		rc = -1;
+	}
+	return rc;
+}
+
+/* Reset session to its full frame, keeping film and passes as they were on
+ * the last full reset. Only what has been tagged gets updated by
+ * Scene::device_update, the rest of the device data stays in place. The
+ * camera is tagged here rather than updated with Camera::update, which
+ * would clear the tag before the scene ever sees it.
+ */
+static int session_reset_tagged(unsigned int client_id, unsigned int session_id, const char* what)
+{
+	RenderCrashTranslatorHelper render_crash_helper(render_crash_translator);
+
+	int rc = 0;
+	CCSession* ccsess = nullptr;
+	ccl::Session* session = nullptr;
+	if (session_find(session_id, &ccsess, &session)) {
+		try {
+			logger.logit(client_id, "Reset ", what, " for session ", session_id);
+			session->scene->camera->need_update = true;
+
+			/* back to the full frame if a region was being rendered. */
+			ccsess->buffer_params = ccsess->full_buffer_params;
+
+			ccsess->mark_reset();
+			session->reset(ccsess->buffer_params, ccsess->params.samples);
+		}
+		catch (CyclesRenderCrashException)
+		{
+			rc = -13;
+		}
+		catch (...)
+		{
+			rc = -13;
+		}
+	}
+	else {
+		rc = -1;
+	}
+	return rc;
+}
+
+int cycles_session_reset_camera(unsigned int client_id, unsigned int session_id)
+{
+	/* Only the camera changed: buffer size and passes are as they were on
+	 * the last full reset, so only the camera needs an update.
+	 */
+	return session_reset_tagged(client_id, session_id, "camera");
+}
+
+int cycles_session_reset_frame(unsigned int client_id, unsigned int session_id)
+{
+	/* Whatever cycles_scene_apply_frame and the camera setters tagged is
+	 * all that gets updated. Not every camera setter tags the camera, which
+	 * is why the camera always gets tagged.
+	 */
+	return session_reset_tagged(client_id, session_id, "frame");
+}
+
+double cycles_session_get_reset_latency(unsigned int client_id, unsigned int session_id)
+{
+	CCSession* ccsess = nullptr;
+	ccl::Session* session = nullptr;
+	if (session_find(session_id, &ccsess, &session)) {
+		return ccsess->reset_latency;
+	}
+	return -1.0;
+}
+
 void cycles_session_set_update_callback(unsigned int client_id, unsigned int session_id, void(*update)(unsigned int sid))
 {
 	CCSession* ccsess = nullptr;
@@ -409,6 +770,20 @@ void cycles_session_set_update_tile_callback(unsigned int client_id, unsigned in
 	}
 }
 
+void cycles_session_set_progressive_preview(unsigned int client_id, unsigned int session_id, unsigned int enable)
+{
+	CCSession* ccsess = nullptr;
+	ccl::Session* session = nullptr;
+	if (session_find(session_id, &ccsess, &session)) {
+		ccsess->progressive_preview = enable == 1;
+		if (!ccsess->progressive_preview) {
+			ccsess->preview_pixels.clear();
+			ccsess->preview_pixels.shrink_to_fit();
+		}
+		logger.logit(client_id, "Set progressive preview for session ", session_id, " to ", enable);
+	}
+}
+
 void cycles_session_set_write_tile_callback(unsigned int client_id, unsigned int session_id, RENDER_TILE_CB write_tile_cb)
 {
 #if 0
@@ -497,16 +872,28 @@ int cycles_session_sample(unsigned int client_id, unsigned int session_id)
 		ccl::Session* session = nullptr;
 		if (session_find(session_id, &ccsess, &session)) {
 			logger.logit(client_id, "Starting session ", session_id);
+			render_scheduler.acquire(session_id);
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 			rc = session->sample();
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			render_scheduler.release(session_id);
+			if (rc >= 0) {
+				ccsess->mark_sample_done();
+				ccsess->mark_sample_time(elapsed.count());
+				ccsess->push_preview(rc);
+				ccsess->denoise_after_sample(rc);
+			}
 		}
 		return rc;
 	}
 	catch (CyclesRenderCrashException)
 	{
+		render_scheduler.release(session_id);
 		return -13;
 	}
 	catch (...)
 	{
+		render_scheduler.release(session_id);
 		return -13;
 	}
 }
@@ -581,6 +968,49 @@ void cycles_session_get_float_buffer(unsigned int client_id, unsigned int sessio
 	}
 }
 
+void cycles_session_get_composited_buffer(unsigned int client_id, unsigned int session_id, int passtype, float** pixels)
+{
+	ccl::DeviceDrawParams draw_params = ccl::DeviceDrawParams();
+	draw_params.bind_display_space_shader_cb = nullptr;
+	draw_params.unbind_display_space_shader_cb = nullptr;
+
+	CCSession* ccsess = nullptr;
+	ccl::Session* session = nullptr;
+	if (session_find(session_id, &ccsess, &session)) {
+		const ccl::BufferParams& bp = ccsess->buffer_params;
+		const ccl::BufferParams& full = ccsess->full_buffer_params;
+		ccl::PassType pt = (ccl::PassType)passtype;
+		if (!ccl::Pass::contains(bp.passes, pt) || !session->display_buffers[pt]) return;
+
+		std::vector<float>& frame = ccsess->retained_frames[passtype];
+		size_t full_size = (size_t)full.width * full.height * 4;
+		if (frame.size() != full_size) {
+			frame.assign(full_size, 0.0f);
+		}
+
+		ccl::DisplayBuffer* db = session->display_buffers[pt];
+		float* region = (float*)db->prepare_pixels(session->device, draw_params);
+
+		/* Only composite once the region renders at its final resolution,
+		 * coarse start resolution frames would otherwise be stretched.
+		 */
+		if (region != nullptr && db->draw_width == bp.width && db->draw_height == bp.height) {
+			/* region position within the frame of the last full reset. */
+			int x = bp.full_x - full.full_x;
+			int y = bp.full_y - full.full_y;
+			int w = ccl::min(bp.width, full.width - x);
+			int h = ccl::min(bp.height, full.height - y);
+			for (int row = 0; x >= 0 && y >= 0 && w > 0 && row < h; row++) {
+				const float* src = region + (size_t)row * bp.width * 4;
+				float* dst = frame.data() + ((size_t)(y + row) * full.width + x) * 4;
+				memcpy(dst, src, sizeof(float) * 4 * w);
+			}
+		}
+
+		*pixels = frame.data();
+	}
+}
+
 void cycles_progress_reset(unsigned int client_id, unsigned int session_id)
 {
 	CCSession* ccsess = nullptr;
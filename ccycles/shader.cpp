@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "internal_types.h"
 
+#include <cstring>
+
 void _init_shaders(unsigned int client_id, unsigned int scene_id)
 {
 	cycles_create_shader(client_id, scene_id); // default surface
@@ -346,7 +348,7 @@ unsigned int cycles_add_shader_node(unsigned int client_id, unsigned int scene_i
 			break;
 		case shadernode_type::NORMALMAP:
 			node = new ccl::NormalMapNode();
-			dynamic_cast<ccl::NormalMapNode*>(node)->attribute = OpenImageIO_v2_0::ustring("uvmap1");
+			dynamic_cast<ccl::NormalMapNode*>(node)->attribute = cached_ustring("uvmap1");
 			break;
 		case shadernode_type::WIREFRAME:
 			node = new ccl::WireframeNode();
@@ -359,7 +361,7 @@ unsigned int cycles_add_shader_node(unsigned int client_id, unsigned int scene_i
 			break;
 		case shadernode_type::TANGENT:
 			node = new ccl::TangentNode();
-			dynamic_cast<ccl::TangentNode*>(node)->attribute = OpenImageIO_v2_0::ustring("uvmap1");
+			dynamic_cast<ccl::TangentNode*>(node)->attribute = cached_ustring("uvmap1");
 			dynamic_cast<ccl::TangentNode*>(node)->direction_type = ccl::NodeTangentDirectionType::NODE_TANGENT_UVMAP;
 			break;
 		case shadernode_type::DISPLACEMENT:
@@ -391,34 +393,44 @@ struct attrunion {
 	};
 };
 
+/* Find input of shnode called name. Exact matches come first,
+ * case-insensitive compares are only the fallback. name is not interned,
+ * so looking up an input that does not exist leaves the ustring table alone.
+ */
+static ccl::ShaderInput* _shader_node_find_input(ccl::ShaderNode* shnode, const char* name)
+{
+	if (name == nullptr) return nullptr;
+	for (ccl::ShaderInput* inp : shnode->inputs) {
+		if (std::strcmp(inp->name().c_str(), name) == 0) return inp;
+	}
+	for (ccl::ShaderInput* inp : shnode->inputs) {
+		if (ccl::string_iequals(inp->name().string(), name)) return inp;
+	}
+	return nullptr;
+}
+
 void shadernode_set_attribute(unsigned int client_id, unsigned int scene_id, unsigned int shader_id, unsigned int shnode_id, const char* attribute_name, attrunion v)
 {
-	auto attr = std::string(attribute_name);
 	ccl::ShaderNode* shnode = _shader_node_find(scene_id, shader_id, shnode_id);
-	if (shnode) {
-		for (ccl::ShaderInput* inp : shnode->inputs) {
-			auto inpname = inp->name().string();
-			if (ccl::string_iequals(inpname, attribute_name)) {
-				switch (v.type) {
-				case attr_type::INT:
-					inp->set(v.i);
-					logger.logit(client_id, "shader_id: ", shader_id, " -> shnode_id: ", shnode_id, " |> setting attribute: ", attribute_name, " to: ", v.i);
-					break;
-				case attr_type::FLOAT:
-					inp->set(v.f);
-					logger.logit(client_id, "shader_id: ", shader_id, " -> shnode_id: ", shnode_id, " |> setting attribute: ", attribute_name, " to: ", v.f);
-					break;
-				case attr_type::FLOAT4:
-					ccl::float3 f3;
-					f3.x = v.f4.x;
-					f3.y = v.f4.y;
-					f3.z = v.f4.z;
-					inp->set(f3);
-					logger.logit(client_id, "shader_id: ", shader_id, " -> shnode_id: ", shnode_id, " |> setting attribute: ", attribute_name, " to: ", v.f4.x, ",", v.f4.y, ",", v.f4.z);
-					break;
-				}
-				return;
-			}
+	ccl::ShaderInput* inp = shnode ? _shader_node_find_input(shnode, attribute_name) : nullptr;
+	if (inp) {
+		switch (v.type) {
+		case attr_type::INT:
+			inp->set(v.i);
+			logger.logit(client_id, "shader_id: ", shader_id, " -> shnode_id: ", shnode_id, " |> setting attribute: ", attribute_name, " to: ", v.i);
+			break;
+		case attr_type::FLOAT:
+			inp->set(v.f);
+			logger.logit(client_id, "shader_id: ", shader_id, " -> shnode_id: ", shnode_id, " |> setting attribute: ", attribute_name, " to: ", v.f);
+			break;
+		case attr_type::FLOAT4:
+			ccl::float3 f3;
+			f3.x = v.f4.x;
+			f3.y = v.f4.y;
+			f3.z = v.f4.z;
+			inp->set(f3);
+			logger.logit(client_id, "shader_id: ", shader_id, " -> shnode_id: ", shnode_id, " |> setting attribute: ", attribute_name, " to: ", v.f4.x, ",", v.f4.y, ",", v.f4.z);
+			break;
 		}
 	}
 }
@@ -862,13 +874,43 @@ CCImage* find_existing_ccimage(std::string imgname, unsigned int width, unsigned
 	return existing_image;
 }
 
+/* Hash of image pixels. Hosts tend to set the same image again, for instance
+ * every time an environment gets re-applied, and re-uploading it also
+ * rebuilds the background importance map. Reads the buffer in 64-bit words,
+ * so hashing is bound by memory bandwidth.
+ */
+static uint64_t _image_content_hash(const void* data, size_t size)
+{
+	const uint64_t prime = 0x100000001b3ULL;
+	uint64_t h = 0xcbf29ce484222325ULL ^ size;
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	const size_t words = size / sizeof(uint64_t);
+	for (size_t i = 0; i < words; i++) {
+		uint64_t w;
+		memcpy(&w, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+		h = (h ^ w) * prime;
+		h ^= h >> 29;
+	}
+	for (size_t i = words * sizeof(uint64_t); i < size; i++) {
+		h = (h ^ bytes[i]) * prime;
+	}
+	return h;
+}
+
+/* Get image for given pixels, reusing an existing image of same name and
+ * dimensions. content_changed is false if such an image already held
+ * identical pixels, in which case it doesn't need reloading.
+ */
 template <class T>
-CCImage* get_ccimage(std::string imgname, T* img, unsigned int width, unsigned int height, unsigned int depth, unsigned int channels, bool is_float, unsigned int scene_id)
+CCImage* get_ccimage(std::string imgname, T* img, unsigned int width, unsigned int height, unsigned int depth, unsigned int channels, bool is_float, unsigned int scene_id, bool& content_changed)
 {
 	CCImage* nimg = nullptr;
 	CCScene* csce = nullptr;
 	ccl::Scene* sce = nullptr;
+	content_changed = true;
 	if (scene_find(scene_id, &csce, &sce)) {
+		const uint64_t content_hash = _image_content_hash(img, sizeof(T) * width * height * depth * channels);
 		CCImage* existing_image = find_existing_ccimage(imgname, width, height, depth, channels, is_float, csce);
 		nimg = existing_image ? existing_image : new CCImage();
 		if (!existing_image) {
@@ -895,12 +937,21 @@ CCImage* get_ccimage(std::string imgname, T* img, unsigned int width, unsigned i
 		}
 		else {
 			existing_image->builtin_data = img;
+			content_changed = existing_image->content_hash != content_hash;
 		}
+		nimg->content_hash = content_hash;
 
 	}
 	return nimg;
 }
 
+/* Tag image imname for reloading, counted in csce->image_reloads. */
+static void _tag_image_reload(CCScene* csce, ccl::Scene* sce, const std::string& imname)
+{
+	csce->image_reloads++;
+	sce->image_manager->tag_reload_image(imname);
+}
+
 void cycles_shadernode_set_member_float_img(unsigned int client_id, unsigned int scene_id, unsigned int shader_id, unsigned int shnode_id, shadernode_type shn_type, const char* member_name, const char* img_name, float* img, unsigned int width, unsigned int height, unsigned int depth, unsigned int channels)
 {
 	CCScene* csce = nullptr;
@@ -915,20 +966,26 @@ void cycles_shadernode_set_member_float_img(unsigned int client_id, unsigned int
 			switch (shn_type) {
 			case shadernode_type::IMAGE_TEXTURE:
 			{
-				CCImage* nimg = get_ccimage<float>(imname, img, width, height, depth, channels, true, scene_id);
+				bool content_changed = true;
+				CCImage* nimg = get_ccimage<float>(imname, img, width, height, depth, channels, true, scene_id, content_changed);
 				ccl::ImageTextureNode* imtex = dynamic_cast<ccl::ImageTextureNode*>(shnode);
 				imtex->builtin_data = nimg;
 				imtex->filename = nimg->filename;
-				sce->image_manager->tag_reload_image(imname);
+				if (content_changed) {
+					_tag_image_reload(csce, sce, imname);
+				}
 			}
 			break;
 			case shadernode_type::ENVIRONMENT_TEXTURE:
 			{
-				CCImage* nimg = get_ccimage<float>(imname, img, width, height, depth, channels, true, scene_id);
+				bool content_changed = true;
+				CCImage* nimg = get_ccimage<float>(imname, img, width, height, depth, channels, true, scene_id, content_changed);
 				ccl::EnvironmentTextureNode* envtex = dynamic_cast<ccl::EnvironmentTextureNode*>(shnode);
 				envtex->builtin_data = nimg;
 				envtex->filename = nimg->filename;
-				sce->image_manager->tag_reload_image(imname);
+				if (content_changed) {
+					_tag_image_reload(csce, sce, imname);
+				}
 			}
 			break;
 			default:
@@ -952,20 +1009,26 @@ void cycles_shadernode_set_member_byte_img(unsigned int client_id, unsigned int
 			switch (shn_type) {
 			case shadernode_type::IMAGE_TEXTURE:
 			{
-				CCImage* nimg = get_ccimage<unsigned char>(imname, img, width, height, depth, channels, false, scene_id);
+				bool content_changed = true;
+				CCImage* nimg = get_ccimage<unsigned char>(imname, img, width, height, depth, channels, false, scene_id, content_changed);
 				ccl::ImageTextureNode* imtex = dynamic_cast<ccl::ImageTextureNode*>(shnode);
 				imtex->builtin_data = nimg;
 				imtex->filename = nimg->filename;
-				sce->image_manager->tag_reload_image(imname);
+				if (content_changed) {
+					_tag_image_reload(csce, sce, imname);
+				}
 			}
 			break;
 			case shadernode_type::ENVIRONMENT_TEXTURE:
 			{
-				CCImage* nimg = get_ccimage<unsigned char>(imname, img, width, height, depth, channels, false, scene_id);
+				bool content_changed = true;
+				CCImage* nimg = get_ccimage<unsigned char>(imname, img, width, height, depth, channels, false, scene_id, content_changed);
 				ccl::EnvironmentTextureNode* envtex = dynamic_cast<ccl::EnvironmentTextureNode*>(shnode);
 				envtex->builtin_data = nimg;
 				envtex->filename = nimg->filename;
-				sce->image_manager->tag_reload_image(imname);
+				if (content_changed) {
+					_tag_image_reload(csce, sce, imname);
+				}
 			}
 			break;
 			default:
@@ -976,6 +1039,16 @@ void cycles_shadernode_set_member_byte_img(unsigned int client_id, unsigned int
 	}
 }
 
+unsigned int cycles_scene_image_reload_count(unsigned int client_id, unsigned int scene_id)
+{
+	CCScene* csce = nullptr;
+	ccl::Scene* sce = nullptr;
+	if (scene_find(scene_id, &csce, &sce)) {
+		return csce->image_reloads;
+	}
+	return 0;
+}
+
 void cycles_shadernode_set_member_bool(unsigned int client_id, unsigned int scene_id, unsigned int shader_id, unsigned int shnode_id, shadernode_type shn_type, const char* member_name, bool value)
 {
 	auto mname = std::string{ member_name };
@@ -1468,6 +1541,45 @@ void cycles_shader_connect_nodes(unsigned int client_id, unsigned int scene_id,
 }
 
 
+int cycles_shader_optimize_graph(unsigned int client_id, unsigned int scene_id, unsigned int shader_id)
+{
+	CCScene* csce = nullptr;
+	ccl::Scene* sce = nullptr;
+	if (!scene_find(scene_id, &csce, &sce) || shader_id >= csce->shaders.size()) return -1;
+
+	CCShader* sh = csce->shaders[shader_id];
+	ccl::ShaderGraph* graph = sh->graph;
+	if (graph->simplified) return -2;
+
+	/* Node ids are never reused, unlike addresses of deleted nodes, so the
+	 * removed nodes are found by id.
+	 */
+	std::map<int, std::string> before;
+	for (ccl::ShaderNode* node : graph->nodes) {
+		before[node->id] = node->type->name.string();
+	}
+
+	/* Cycles' own pass: folds constant math, vector math and mix chains,
+	 * merges identical nodes such as duplicate texture lookups, and drops
+	 * everything not reachable from the output. Shader compile runs the
+	 * same pass, this only runs it early so the removed nodes can be
+	 * reported. It marks the graph as simplified, so compile won't run it
+	 * a second time.
+	 */
+	graph->simplify(sce);
+
+	for (ccl::ShaderNode* node : graph->nodes) {
+		before.erase(node->id);
+	}
+	for (auto& removed : before) {
+		logger.logit(client_id, "Shader ", shader_id, " :: optimized away node ", removed.first, " (", removed.second, ")");
+	}
+	logger.logit(client_id, "Shader ", shader_id, " :: ", before.size(), " nodes removed, ", graph->nodes.size(), " remaining");
+
+	sh->shader->tag_update(sce);
+
+	return (int)before.size();
+}
 
 class GammaLUT
 {
@@ -0,0 +1,73 @@
+/**
+Copyright 2014-2017 Robert McNeel and Associates
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+**/
+
+#include "internal_types.h"
+
+#include <cstring>
+#include <unordered_map>
+
+/* Upper bound on names cached per thread. A thread that sees more unique
+ * names than this starts over with an empty cache.
+ */
+static const size_t ustring_cache_max{ 4096 };
+
+/* Keys are the characters of the interned ustring, which live as long as
+ * the ustring table. Hashing and comparing by content lets a lookup use the
+ * caller's const char* directly, without building a std::string.
+ */
+struct cstr_hash {
+	size_t operator()(const char* s) const
+	{
+		/* FNV-1a */
+		size_t h = static_cast<size_t>(14695981039346656037ULL);
+		for (; *s; ++s) {
+			h ^= static_cast<unsigned char>(*s);
+			h *= static_cast<size_t>(1099511628211ULL);
+		}
+		return h;
+	}
+};
+
+struct cstr_equal {
+	bool operator()(const char* a, const char* b) const
+	{
+		return std::strcmp(a, b) == 0;
+	}
+};
+
+ccl::ustring cached_ustring(const char* name)
+{
+	if (name == nullptr) return ccl::ustring();
+
+	/* The ustring table takes a lock on every lookup. Names seen before on
+	 * this thread are found here without touching the table.
+	 */
+	thread_local std::unordered_map<const char*, ccl::ustring, cstr_hash, cstr_equal> cache;
+
+	auto it = cache.find(name);
+	if (it != cache.end()) return it->second;
+
+	if (cache.size() >= ustring_cache_max) cache.clear();
+
+	ccl::ustring u(name);
+	cache.emplace(u.c_str(), u);
+	return u;
+}
+
+ccl::ustring cached_ustring(const std::string& name)
+{
+	return cached_ustring(name.c_str());
+}
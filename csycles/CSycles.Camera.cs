@@ -144,6 +144,25 @@ namespace ccl
 			cycles_camera_set_shuttertime(clientId, sceneId, shuttertime);
 		}
 
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private unsafe static extern int cycles_camera_set_motion(uint clientId, uint sceneId, uint steps, float* transforms);
+		/// <summary>
+		/// Set camera motion transforms, spread evenly over the shutter. Needs an odd count,
+		/// null or fewer than two transforms clear camera motion.
+		/// </summary>
+		public static int camera_set_motion(uint clientId, uint sceneId, Transform[] transforms)
+		{
+			var steps = transforms != null && transforms.Length > 1 ? transforms.Length : 0;
+			var tfms = steps > 0 ? transforms_to_floats(transforms) : null;
+			unsafe
+			{
+				fixed (float* ptfms = tfms)
+				{
+					return cycles_camera_set_motion(clientId, sceneId, (uint)steps, ptfms);
+				}
+			}
+		}
+
 		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
 		private static extern void cycles_camera_set_focaldistance(uint clientId, uint sceneId, float focaldistance);
 		public static void camera_set_focaldistance(uint clientId, uint sceneId, float focaldistance)
@@ -131,6 +131,13 @@ namespace ccl
 			cycles_integrator_set_no_caustics(clientId, sceneId, value);
 		}
 		
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_integrator_set_motion_blur(uint clientId, uint sceneId, bool value);
+		public static void integrator_set_motion_blur(uint clientId, uint sceneId, bool value)
+		{
+			cycles_integrator_set_motion_blur(clientId, sceneId, value);
+		}
+
 		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
 		private static extern void cycles_integrator_set_no_shadows(uint clientId, uint sceneId, bool value);
 		public static void integrator_set_no_shadows(uint clientId, uint sceneId, bool value)
@@ -80,6 +80,135 @@ namespace ccl
 			cycles_scene_object_set_is_block_instance(clientId, sceneId, objectId, is_block_instance);
 		}
 
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private unsafe static extern uint cycles_scene_add_object_instances(uint clientId, uint sceneId, uint meshId, uint count,
+			float* transforms, int* passIds, uint* randomIds, uint* shaderIds);
+		/// <summary>
+		/// Add transforms.Length instances of meshId as block instances sharing one mesh BVH.
+		/// passIds, randomIds and shaderIds are optional, pass null to keep the defaults.
+		/// A shader id of uint.MaxValue keeps the mesh shaders. Returns the id of the first
+		/// instance, the others follow consecutively.
+		/// </summary>
+		public static uint scene_add_object_instances(uint clientId, uint sceneId, uint meshId, Transform[] transforms, int[] passIds, uint[] randomIds, uint[] shaderIds)
+		{
+			var tfms = transforms_to_floats(transforms);
+			unsafe
+			{
+				fixed (float* ptfms = tfms)
+				fixed (int* ppassIds = passIds)
+				fixed (uint* prandomIds = randomIds)
+				fixed (uint* pshaderIds = shaderIds)
+				{
+					return cycles_scene_add_object_instances(clientId, sceneId, meshId, (uint)transforms.Length, ptfms, ppassIds, prandomIds, pshaderIds);
+				}
+			}
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern uint cycles_scene_object_count(uint clientId, uint sceneId);
+		public static uint scene_object_count(uint clientId, uint sceneId)
+		{
+			return cycles_scene_object_count(clientId, sceneId);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private unsafe static extern void cycles_scene_object_instances_set_matrices(uint clientId, uint sceneId, uint firstObjectId, uint count, float* transforms);
+		public static void object_instances_set_matrices(uint clientId, uint sceneId, uint firstObjectId, Transform[] transforms)
+		{
+			var tfms = transforms_to_floats(transforms);
+			unsafe
+			{
+				fixed (float* ptfms = tfms)
+				{
+					cycles_scene_object_instances_set_matrices(clientId, sceneId, firstObjectId, (uint)transforms.Length, ptfms);
+				}
+			}
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private unsafe static extern int cycles_scene_object_set_motion(uint clientId, uint sceneId, uint objectId, uint steps, float* transforms);
+		/// <summary>
+		/// Set motion transforms of object, spread evenly over the shutter. Needs an odd count,
+		/// null or fewer than two transforms clear object motion.
+		/// </summary>
+		public static int object_set_motion(uint clientId, uint sceneId, uint objectId, Transform[] transforms)
+		{
+			var steps = transforms != null && transforms.Length > 1 ? transforms.Length : 0;
+			var tfms = steps > 0 ? transforms_to_floats(transforms) : null;
+			unsafe
+			{
+				fixed (float* ptfms = tfms)
+				{
+					return cycles_scene_object_set_motion(clientId, sceneId, objectId, (uint)steps, ptfms);
+				}
+			}
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private unsafe static extern int cycles_scene_objects_set_properties(uint clientId, uint sceneId, uint count, uint* objectIds,
+			uint* visibility, uint* shaderIds, int* passIds, uint* randomIds, bool* isShadowcatcher, bool* meshLightNoCastShadow, bool* isBlockInstance);
+		/// <summary>
+		/// Set properties of many objects at once. Every array but objectIds holds one value
+		/// per object and may be null to leave that property unchanged. objectIds may be null
+		/// to address objects 0 to count-1. Returns the number of objects set, -1 if the scene
+		/// wasn't found and -2 on an invalid object or shader id.
+		/// </summary>
+		public static int scene_objects_set_properties(uint clientId, uint sceneId, uint count, uint[] objectIds,
+			PathRay[] visibility, uint[] shaderIds, int[] passIds, uint[] randomIds, bool[] isShadowcatcher, bool[] meshLightNoCastShadow, bool[] isBlockInstance)
+		{
+			unsafe
+			{
+				fixed (uint* pobjectIds = objectIds)
+				fixed (PathRay* pvis = visibility)
+				fixed (uint* pshaderIds = shaderIds)
+				fixed (int* ppassIds = passIds)
+				fixed (uint* prandomIds = randomIds)
+				fixed (bool* pisShadowcatcher = isShadowcatcher)
+				fixed (bool* pmeshLightNoCastShadow = meshLightNoCastShadow)
+				fixed (bool* pisBlockInstance = isBlockInstance)
+				{
+					return cycles_scene_objects_set_properties(clientId, sceneId, count, pobjectIds, (uint*)pvis, pshaderIds, ppassIds, prandomIds,
+						pisShadowcatcher, pmeshLightNoCastShadow, pisBlockInstance);
+				}
+			}
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private unsafe static extern int cycles_scene_apply_frame(uint clientId, uint sceneId, uint count, uint* objectIds, float* transforms, uint* shaderIds);
+		/// <summary>
+		/// Apply transforms and shaders of the next animation frame. objectIds may be null
+		/// to address objects 0 to count-1, transforms and shaderIds may be null to leave
+		/// them unchanged. Returns the number of objects that changed.
+		/// </summary>
+		public static int scene_apply_frame(uint clientId, uint sceneId, uint[] objectIds, Transform[] transforms, uint[] shaderIds)
+		{
+			var count = objectIds != null ? objectIds.Length : transforms != null ? transforms.Length : shaderIds != null ? shaderIds.Length : 0;
+			var tfms = transforms != null ? transforms_to_floats(transforms) : null;
+			unsafe
+			{
+				fixed (uint* pobjectIds = objectIds)
+				fixed (float* ptfms = tfms)
+				fixed (uint* pshaderIds = shaderIds)
+				{
+					return cycles_scene_apply_frame(clientId, sceneId, (uint)count, pobjectIds, ptfms, pshaderIds);
+				}
+			}
+		}
+
+		private static float[] transforms_to_floats(Transform[] transforms)
+		{
+			var tfms = new float[transforms.Length * 12];
+			for (var i = 0; i < transforms.Length; i++)
+			{
+				var t = transforms[i];
+				var o = i * 12;
+				tfms[o + 0] = t.x.x; tfms[o + 1] = t.x.y; tfms[o + 2] = t.x.z; tfms[o + 3] = t.x.w;
+				tfms[o + 4] = t.y.x; tfms[o + 5] = t.y.y; tfms[o + 6] = t.y.z; tfms[o + 7] = t.y.w;
+				tfms[o + 8] = t.z.x; tfms[o + 9] = t.z.y; tfms[o + 10] = t.z.z; tfms[o + 11] = t.z.w;
+			}
+			return tfms;
+		}
+
 		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
 		private static extern void cycles_scene_object_set_cutout(uint clientId, uint sceneId, uint objectId, bool cutout);
 		public static void object_set_cutout(uint clientId, uint sceneId, uint objectId, bool cutout)
@@ -41,6 +41,13 @@ namespace ccl
 			cycles_scene_unlock(clientId, sceneId);
 		}
 
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern uint cycles_scene_get_update_flags(uint clientId, uint sceneId);
+		public static SceneUpdateFlags scene_get_update_flags(uint clientId, uint sceneId)
+		{
+			return (SceneUpdateFlags)cycles_scene_get_update_flags(clientId, sceneId);
+		}
+
 		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
 		private static extern uint cycles_scene_add_object(uint clientId, uint sceneId);
 		public static uint scene_add_object(uint clientId, uint sceneId)
@@ -13,6 +13,34 @@ namespace ccl
 			return cycles_session_reset(clientId, sessionId, width, height, samples, full_x, full_y, full_width, full_height );
 		}
 
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern int cycles_session_reset_region(uint clientId, uint sessionId, uint x, uint y, uint width, uint height, uint samples);
+		public static int session_reset_region(uint clientId, uint sessionId, uint x, uint y, uint width, uint height, uint samples)
+		{
+			return cycles_session_reset_region(clientId, sessionId, x, y, width, height, samples);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern int cycles_session_reset_camera(uint clientId, uint sessionId);
+		public static int session_reset_camera(uint clientId, uint sessionId)
+		{
+			return cycles_session_reset_camera(clientId, sessionId);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern int cycles_session_reset_frame(uint clientId, uint sessionId);
+		public static int session_reset_frame(uint clientId, uint sessionId)
+		{
+			return cycles_session_reset_frame(clientId, sessionId);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern double cycles_session_get_reset_latency(uint clientId, uint sessionId);
+		public static double session_get_reset_latency(uint clientId, uint sessionId)
+		{
+			return cycles_session_get_reset_latency(clientId, sessionId);
+		}
+
 		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
 		private static extern void cycles_session_add_pass(uint client_id, uint session_id, int pass_id);
 		public static void session_add_pass(uint client_id, uint session_id, PassType pass_id)
@@ -48,6 +76,75 @@ namespace ccl
 			return cycles_session_destroy(clientId, sessionId, sceneId);
 		}
 
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_session_pool_set_capacity(uint clientId, uint capacity);
+		public static void session_pool_set_capacity(uint clientId, uint capacity)
+		{
+			cycles_session_pool_set_capacity(clientId, capacity);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern uint cycles_session_pool_size(uint clientId);
+		public static uint session_pool_size(uint clientId)
+		{
+			return cycles_session_pool_size(clientId);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_session_pool_clear(uint clientId);
+		public static void session_pool_clear(uint clientId)
+		{
+			cycles_session_pool_clear(clientId);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_scheduler_set_max_concurrent(uint clientId, uint maxConcurrent);
+		public static void scheduler_set_max_concurrent(uint clientId, uint maxConcurrent)
+		{
+			cycles_scheduler_set_max_concurrent(clientId, maxConcurrent);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_scheduler_set_max_threads(uint clientId, uint maxThreads);
+		public static void scheduler_set_max_threads(uint clientId, uint maxThreads)
+		{
+			cycles_scheduler_set_max_threads(clientId, maxThreads);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_session_set_priority(uint clientId, uint sessionId, int priority);
+		public static void session_set_priority(uint clientId, uint sessionId, int priority)
+		{
+			cycles_session_set_priority(clientId, sessionId, priority);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_session_set_weight(uint clientId, uint sessionId, float weight);
+		public static void session_set_weight(uint clientId, uint sessionId, float weight)
+		{
+			cycles_session_set_weight(clientId, sessionId, weight);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_session_get_throughput(uint clientId, uint sessionId, out double pixelSamplesPerSecond, out double utilization);
+		public static void session_get_throughput(uint clientId, uint sessionId, out double pixelSamplesPerSecond, out double utilization)
+		{
+			cycles_session_get_throughput(clientId, sessionId, out pixelSamplesPerSecond, out utilization);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private unsafe static extern int cycles_session_group_balance(uint clientId, uint count, uint* sessionIds, uint samples);
+		public static int session_group_balance(uint clientId, uint[] sessionIds, uint samples)
+		{
+			unsafe
+			{
+				fixed (uint* psessionIds = sessionIds)
+				{
+					return cycles_session_group_balance(clientId, (uint)sessionIds.Length, psessionIds, samples);
+				}
+			}
+		}
+
 		[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
 		public delegate void UpdateCallback(uint sid);
 		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
@@ -75,6 +172,12 @@ namespace ccl
 			cycles_session_set_update_tile_callback(clientId, sessionId, renderTileCb);
 		}
 		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_session_set_progressive_preview(uint clientId, uint sessionId, uint enable);
+		public static void session_set_progressive_preview(uint clientId, uint sessionId, bool enable)
+		{
+			cycles_session_set_progressive_preview(clientId, sessionId, (uint)(enable ? 1 : 0));
+		}
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
 		private static extern void cycles_session_set_write_tile_callback(uint clientId, uint sessionId, RenderTileCallback renderTileCb);
 		public static void session_set_write_tile_callback(uint clientId, uint sessionId, RenderTileCallback renderTileCb)
 		{
@@ -160,6 +263,63 @@ namespace ccl
 		{
 			cycles_session_get_float_buffer(clientId, sessionId, (int)passType, ref pixels);
 		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_session_get_composited_buffer(uint clientId, uint sessionId, int passType, ref IntPtr pixels);
+		public static void session_get_composited_buffer(uint clientId, uint sessionId, PassType passType, ref IntPtr pixels)
+		{
+			cycles_session_get_composited_buffer(clientId, sessionId, (int)passType, ref pixels);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_session_set_denoising(uint clientId, uint sessionId, uint iterations, float strength, uint progressive);
+		public static void session_set_denoising(uint clientId, uint sessionId, uint iterations, float strength, bool progressive)
+		{
+			cycles_session_set_denoising(clientId, sessionId, iterations, strength, (uint)(progressive ? 1 : 0));
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern int cycles_session_denoise(uint clientId, uint sessionId);
+		public static int session_denoise(uint clientId, uint sessionId)
+		{
+			return cycles_session_denoise(clientId, sessionId);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_session_get_denoised_buffer(uint clientId, uint sessionId, ref IntPtr pixels, ref double denoiseTime);
+		public static void session_get_denoised_buffer(uint clientId, uint sessionId, ref IntPtr pixels, ref double denoiseTime)
+		{
+			cycles_session_get_denoised_buffer(clientId, sessionId, ref pixels, ref denoiseTime);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+		[System.Diagnostics.CodeAnalysis.SuppressMessage("Globalization", "CA2101:Specify marshaling for P/Invoke string arguments", Justification = "Using simple c string")]
+		private static extern int cycles_session_write_exr(uint clientId, uint sessionId, [MarshalAs(UnmanagedType.LPStr)] string filename, uint tileSize);
+		public static int session_write_exr(uint clientId, uint sessionId, string filename, uint tileSize)
+		{
+			return cycles_session_write_exr(clientId, sessionId, filename, tileSize);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern int cycles_session_wait_exr(uint clientId, uint sessionId);
+		public static int session_wait_exr(uint clientId, uint sessionId)
+		{
+			return cycles_session_wait_exr(clientId, sessionId);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_exr_set_threads(uint clientId, uint writerThreads);
+		public static void exr_set_threads(uint clientId, uint writerThreads)
+		{
+			cycles_exr_set_threads(clientId, writerThreads);
+		}
+
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern void cycles_exr_set_compression_threads(uint clientId, uint compressionThreads);
+		public static void exr_set_compression_threads(uint clientId, uint compressionThreads)
+		{
+			cycles_exr_set_compression_threads(clientId, compressionThreads);
+		}
 		#endregion
 
 		#region session parameters
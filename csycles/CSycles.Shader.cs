@@ -208,6 +208,13 @@ namespace ccl
 			cycles_shadernode_set_member_byte_img(clientId, sceneId, shaderId, shadernodeId, (uint)shnType, name, imgName, img, width, height, depth, channels);
 		}
 
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern uint cycles_scene_image_reload_count(uint clientId, uint sceneId);
+		public static uint scene_image_reload_count(uint clientId, uint sceneId)
+		{
+			return cycles_scene_image_reload_count(clientId, sceneId);
+		}
+
 		[DllImport(Constants.ccycles, SetLastError = false, CharSet = CharSet.Ansi,
 			CallingConvention = CallingConvention.Cdecl)]
 		private static extern void cycles_shader_connect_nodes(uint clientId, uint sceneId, uint shaderId, uint fromId, string from, uint toId,
@@ -217,6 +224,13 @@ namespace ccl
 			cycles_shader_connect_nodes(clientId, sceneId, shaderId, fromId, from, toId, to);
 		}
 
+		[DllImport(Constants.ccycles, SetLastError = false, CallingConvention = CallingConvention.Cdecl)]
+		private static extern int cycles_shader_optimize_graph(uint clientId, uint sceneId, uint shaderId);
+		public static int shader_optimize_graph(uint clientId, uint sceneId, uint shaderId)
+		{
+			return cycles_shader_optimize_graph(clientId, sceneId, shaderId);
+		}
+
 		[DllImport(Constants.ccycles, SetLastError = false, CharSet = CharSet.Ansi,
 			CallingConvention = CallingConvention.Cdecl)]
 		private static extern void cycles_shader_set_name(uint clientId, uint sceneId, uint shaderId, [MarshalAs(UnmanagedType.LPStr)] string name);
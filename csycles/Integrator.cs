@@ -153,6 +153,17 @@ namespace ccl
 			}
 		}
 
+		/// <summary>
+		/// Set to true to blur objects and camera over their motion transforms
+		/// </summary>
+		public bool MotionBlur
+		{
+			set
+			{
+				CSycles.integrator_set_motion_blur(Scene.Client.Id, Scene.Id, value);
+			}
+		}
+
 		/// <summary>
 		/// Set to true if shadows shouldn't be traced
 		/// </summary>
@@ -360,7 +371,9 @@ namespace ccl
 		}
 
 		/// <summary>
-		/// Set light sampling threshold. Contribution below given threshold will be discarded.
+		/// Set light sampling threshold. Shadow rays of light samples contributing less
+		/// than the threshold are terminated by Russian roulette, which keeps the result
+		/// unbiased. Raise for scenes with many lights.
 		/// </summary>
 		public float LightSamplingThreshold
 		{
@@ -200,9 +200,33 @@ namespace ccl
 			CSycles.scene_unlock(Client.Id, Id);
 		}
 
+		/// <summary>
+		/// Parts of the scene that are tagged for update and get synced by the next reset.
+		/// </summary>
+		public SceneUpdateFlags UpdateFlags
+		{
+			get
+			{
+				return CSycles.scene_get_update_flags(Client.Id, Id);
+			}
+		}
+
 		public void ClearClippingPlanes()
 		{
 			CSycles.scene_clear_clipping_planes(Client.Id, Id);
 		}
+
+		/// <summary>
+		/// Apply transforms and shader ids of the next animation frame. Only objects
+		/// that differ from the previous frame get updated. Follow with Session.ResetFrame.
+		/// </summary>
+		/// <param name="objectIds">Objects the other arrays are for, null for objects 0 to n-1</param>
+		/// <param name="transforms">New object transforms, null to leave them unchanged</param>
+		/// <param name="shaderIds">New shader ids, null or uint.MaxValue to leave them unchanged</param>
+		/// <returns>Number of objects that changed</returns>
+		public int ApplyFrame(uint[] objectIds, Transform[] transforms, uint[] shaderIds)
+		{
+			return CSycles.scene_apply_frame(Client.Id, Id, objectIds, transforms, shaderIds);
+		}
 	}
 }
@@ -240,6 +240,82 @@ namespace ccl
 		}
 
 
+		/// <summary>
+		/// Get the full frame buffer for pass type with the rendered region composited in.
+		/// </summary>
+		public void GetCompositedPixelBuffer(PassType pt, ref IntPtr pixel_buffer)
+		{
+			if (Destroyed)
+			{
+				pixel_buffer = IntPtr.Zero;
+			}
+			else
+			{
+				CSycles.session_get_composited_buffer(Client.Id, Id, pt, ref pixel_buffer);
+			}
+		}
+
+		/// <summary>
+		/// Set up the CPU denoiser. Add Normal and DiffCol passes to guide it.
+		/// </summary>
+		/// <param name="iterations">Filter iterations, 0 to disable. Each doubles the footprint.</param>
+		/// <param name="strength">Scale of the color range averaged over, 1.0 default</param>
+		/// <param name="progressive">Denoise every sample instead of only the last one</param>
+		public void SetDenoising(uint iterations, float strength = 1.0f, bool progressive = false)
+		{
+			if (Destroyed) return;
+			CSycles.session_set_denoising(Client.Id, Id, iterations, strength, progressive);
+		}
+
+		/// <summary>
+		/// Denoise the current frame now.
+		/// </summary>
+		/// <returns>0 on success. -1 when the session is already destroyed. -2 when there is nothing to denoise.</returns>
+		public int Denoise()
+		{
+			if (Destroyed) return -1;
+			return CSycles.session_denoise(Client.Id, Id);
+		}
+
+		/// <summary>
+		/// Get the last denoised RGBA frame, IntPtr.Zero if there is none.
+		/// </summary>
+		/// <param name="pixel_buffer">Set to the denoised frame</param>
+		/// <returns>Seconds denoising took, negative if there is no denoised frame</returns>
+		public double GetDenoisedPixelBuffer(ref IntPtr pixel_buffer)
+		{
+			double denoise_time = -1.0;
+			pixel_buffer = IntPtr.Zero;
+			if (!Destroyed)
+			{
+				CSycles.session_get_denoised_buffer(Client.Id, Id, ref pixel_buffer, ref denoise_time);
+			}
+			return denoise_time;
+		}
+
+		/// <summary>
+		/// Write all registered passes as layers of one tiled EXR file. The write
+		/// happens in the background, use WaitExr to wait for it to finish.
+		/// </summary>
+		/// <param name="filename">Path of the EXR file to write</param>
+		/// <param name="tileSize">Tile size, 0 for default of 64</param>
+		/// <returns>0 when queued. -1 when the session is already destroyed. -2 when there is no pass data.</returns>
+		public int WriteExr(string filename, uint tileSize = 0)
+		{
+			if (Destroyed) return -1;
+			return CSycles.session_write_exr(Client.Id, Id, filename, tileSize);
+		}
+
+		/// <summary>
+		/// Wait for all queued EXR writes of this session to finish.
+		/// </summary>
+		/// <returns>0 on success, -3 if a write failed.</returns>
+		public int WaitExr()
+		{
+			if (Destroyed) return 0;
+			return CSycles.session_wait_exr(Client.Id, Id);
+		}
+
 		/// <summary>
 		/// Reset a Session
 		/// </summary>
@@ -259,6 +335,91 @@ namespace ccl
 			return Reset((uint)width, (uint)height, (uint)samples, (uint)full_x, (uint)full_y, (uint)full_width, (uint)full_height);
 		}
 
+		/// <summary>
+		/// Reset a Session to render only a region of the full frame set up with the last Reset.
+		/// </summary>
+		/// <returns>0 on success. -1 when the session is already destroyed. -2 when the region doesn't fit the full frame. -13 when a crash happened.</returns>
+		public int ResetRegion(uint x, uint y, uint width, uint height, uint samples)
+		{
+			if (Destroyed) return -1;
+			CSycles.progress_reset(Client.Id, Id);
+			return CSycles.session_reset_region(Client.Id, Id, x, y, width, height, samples);
+		}
+
+		/// <summary>
+		/// Reset a Session after only the camera has changed. Resolution, samples
+		/// and passes from the last full Reset are kept.
+		/// </summary>
+		/// <returns>0 on success. -1 when the session is already destroyed. -13 when a crash happened.</returns>
+		public int ResetCamera()
+		{
+			if (Destroyed) return -1;
+			CSycles.progress_reset(Client.Id, Id);
+			return CSycles.session_reset_camera(Client.Id, Id);
+		}
+
+		/// <summary>
+		/// Reset a Session for the next frame of an animation, after the frame
+		/// has been applied with Scene.ApplyFrame. Resolution, samples and passes
+		/// from the last full Reset are kept, unchanged device data is reused.
+		/// </summary>
+		/// <returns>0 on success. -1 when the session is already destroyed. -13 when a crash happened.</returns>
+		public int ResetFrame()
+		{
+			if (Destroyed) return -1;
+			CSycles.progress_reset(Client.Id, Id);
+			return CSycles.session_reset_frame(Client.Id, Id);
+		}
+
+		/// <summary>
+		/// Seconds between the last reset and the first completed Sample() after it.
+		/// Negative when no sample has completed since the last reset.
+		/// </summary>
+		public double ResetLatency
+		{
+			get
+			{
+				if (Destroyed) return -1.0;
+				return CSycles.session_get_reset_latency(Client.Id, Id);
+			}
+		}
+
+		/// <summary>
+		/// Get measured render throughput in pixel samples per second, and the
+		/// fraction of the time since the last reset spent sampling.
+		/// </summary>
+		public void GetThroughput(out double pixelSamplesPerSecond, out double utilization)
+		{
+			if (Destroyed)
+			{
+				pixelSamplesPerSecond = 0.0;
+				utilization = 0.0;
+				return;
+			}
+			CSycles.session_get_throughput(Client.Id, Id, out pixelSamplesPerSecond, out utilization);
+		}
+
+		/// <summary>
+		/// Split the full frame across sessions rendering on different devices, in
+		/// proportion to their measured throughput. Each session gets reset to render
+		/// a band of rows, top to bottom in the order given. All sessions must have
+		/// been Reset to the same full frame. This balances separate sessions, not
+		/// the sub-devices of a multi-device.
+		/// </summary>
+		/// <returns>0 on success. -1 when a session is destroyed. -2 when the sessions don't share a full frame. -13 when a crash happened.</returns>
+		public static int Balance(Session[] sessions, uint samples)
+		{
+			if (sessions.Length == 0) return -2;
+			var ids = new uint[sessions.Length];
+			for (var i = 0; i < sessions.Length; i++)
+			{
+				if (sessions[i].Destroyed) return -1;
+				CSycles.progress_reset(sessions[i].Client.Id, sessions[i].Id);
+				ids[i] = sessions[i].Id;
+			}
+			return CSycles.session_group_balance(sessions[0].Client.Id, ids, samples);
+		}
+
 		/// <summary>
 		/// Pause or un-pause a render session.
 		/// </summary>
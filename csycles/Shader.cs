@@ -259,6 +259,18 @@ namespace ccl
 			}
 		}
 
+		/// <summary>
+		/// Fold constants, merge duplicate nodes and remove nodes that don't
+		/// contribute to the output. Call after FinalizeGraph, removed nodes
+		/// are reported through the client logger. Shader compile does the same,
+		/// so this only tells which nodes are redundant.
+		/// </summary>
+		/// <returns>Number of nodes removed, -1 if the shader wasn't found, -2 if the graph was already simplified</returns>
+		public int OptimizeGraph()
+		{
+			return CSycles.shader_optimize_graph(Client.Id, Client.Scene.Id, Id);
+		}
+
 		/// <summary>
 		/// Make the actual connection between nodes.
 		/// </summary>
@@ -239,6 +239,21 @@ namespace ccl
 	}
 
 
+	/// <summary>
+	/// Parts of a scene that can be tagged for update.
+	/// </summary>
+	[Flags]
+	public enum SceneUpdateFlags : uint
+	{
+		None = 0,
+		Objects = 1 << 0,
+		Meshes = 1 << 1,
+		Camera = 1 << 2,
+		Integrator = 1 << 3,
+		Lights = 1 << 4,
+		Images = 1 << 5,
+	}
+
 	[Flags]
 	public enum PathRay : uint
 	{
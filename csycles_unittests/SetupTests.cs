@@ -15,7 +15,7 @@ namespace csycles_unittests
 			var userpath = Path.Combine(path, "userpath");
 
 			CSycles.path_init(path, userpath);
-			CSycles.initialise();
+			CSycles.initialise(DeviceTypeMask.CPU);
 		}
 
 		[OneTimeTearDown]
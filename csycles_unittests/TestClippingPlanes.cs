@@ -0,0 +1,105 @@
+﻿using NUnit.Framework;
+using ccl;
+
+namespace csycles_unittests
+{
+	[TestFixture]
+	public class TestClippingPlanes
+	{
+		const uint Size = 32;
+		const uint Samples = 2;
+
+		/* A and B cut the backdrop through its center along perpendicular
+		 * lines, so whichever side they clip, A always clips a quadrant B
+		 * leaves.
+		 */
+		static readonly float4 PlaneA = new float4(1.0f, 0.0f, 0.0f, 0.0f);
+		static readonly float4 PlaneB = new float4(0.0f, 1.0f, 0.0f, 0.0f);
+		static readonly float4 PlaneBMoved = new float4(0.0f, 1.0f, 0.0f, -0.5f);
+		static readonly float4 PlaneC = new float4(-1.0f, 0.0f, 0.0f, 0.5f);
+
+		static TestRender CreateRender()
+		{
+			var render = new TestRender("scene_cube.xml", Samples, 0, Size, Size);
+			TestFrameReset.AddEmissiveQuad(render, Transform.Translate(0.0f, 0.0f, -2.0f) * Transform.Scale(3.0f, 3.0f, 1.0f));
+			return render;
+		}
+
+		static float[] Render(TestRender render)
+		{
+			TestFrameReset.FullReset(render);
+			render.SampleAll();
+			return render.Pixels();
+		}
+
+		/// <summary>
+		/// Render the backdrop with planes added to a fresh scene in the given order.
+		/// </summary>
+		static float[] RenderWithPlanes(params float4[] planes)
+		{
+			using (var render = CreateRender())
+			{
+				foreach (var plane in planes)
+				{
+					CSycles.scene_add_clipping_plane(render.Client.Id, render.Scene.Id, plane);
+				}
+				return Render(render);
+			}
+		}
+
+		static void AssertMatches(float[] expected, float[] actual, double distinct, string what)
+		{
+			var difference = TestFrameReset.MeanDifference(expected, actual);
+			TestContext.Out.WriteLine("{0}: mean difference {1:G4}", what, difference);
+			Assert.Less(difference, distinct * 0.1, what);
+		}
+
+		/// <summary>
+		/// Clipping plane ids stay valid while other planes get discarded, set
+		/// again and added. A discarded plane no longer clips, setting it again
+		/// brings it back, and setting an id that was never handed out is ignored.
+		/// </summary>
+		[Test]
+		public void DiscardSetAgainAndReAdd()
+		{
+			var expectedB = RenderWithPlanes(PlaneB);
+			var expectedAB = RenderWithPlanes(PlaneA, PlaneB);
+			var expectedBMoved = RenderWithPlanes(PlaneBMoved);
+			var expectedABMoved = RenderWithPlanes(PlaneA, PlaneBMoved);
+			var expectedABMovedC = RenderWithPlanes(PlaneA, PlaneBMoved, PlaneC);
+
+			var distinct = TestFrameReset.MeanDifference(expectedB, expectedAB);
+			Assert.Greater(distinct, 0.0, "plane A clips");
+			Assert.Greater(TestFrameReset.MeanDifference(expectedB, expectedBMoved), 0.0, "moving plane B changes the image");
+
+			using (var render = CreateRender())
+			{
+				var clientId = render.Client.Id;
+				var sceneId = render.Scene.Id;
+
+				var a = CSycles.scene_add_clipping_plane(clientId, sceneId, PlaneA);
+				var b = CSycles.scene_add_clipping_plane(clientId, sceneId, PlaneB);
+				Assert.AreNotEqual(uint.MaxValue, a);
+				Assert.AreNotEqual(uint.MaxValue, b);
+				Assert.AreNotEqual(a, b);
+				AssertMatches(expectedAB, Render(render), distinct, "both planes");
+
+				CSycles.scene_discard_clipping_plane(clientId, sceneId, a);
+				AssertMatches(expectedB, Render(render), distinct, "plane A discarded");
+
+				CSycles.scene_set_clipping_plane(clientId, sceneId, b, PlaneBMoved);
+				CSycles.scene_set_clipping_plane(clientId, sceneId, b + 100, PlaneA);
+				AssertMatches(expectedBMoved, Render(render), distinct, "plane B moved, out of range id set");
+
+				CSycles.scene_set_clipping_plane(clientId, sceneId, a, PlaneA);
+				AssertMatches(expectedABMoved, Render(render), distinct, "plane A set again");
+
+				var c = CSycles.scene_add_clipping_plane(clientId, sceneId, PlaneC);
+				Assert.AreNotEqual(uint.MaxValue, c);
+				Assert.AreNotEqual(a, c);
+				Assert.AreNotEqual(b, c);
+				AssertMatches(expectedABMovedC, Render(render), distinct, "plane C added");
+			}
+		}
+	}
+}
@@ -0,0 +1,114 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using NUnit.Framework;
+using ccl;
+
+namespace csycles_unittests
+{
+	/// <summary>
+	/// Quality and time of the session denoiser on real renders of
+	/// scene_cube.xml: a low sample render is denoised with different
+	/// iteration counts and compared against a high sample reference.
+	/// </summary>
+	[TestFixture]
+	public class TestDenoise
+	{
+		const uint Width = 160;
+		const uint Height = 120;
+		const uint ReferenceSamples = 256;
+		const uint NoisySamples = 8;
+
+		static float[] Reference()
+		{
+			using (var render = new TestRender("scene_cube.xml", ReferenceSamples, 0, Width, Height))
+			{
+				Assert.AreEqual((int)ReferenceSamples, render.SampleAll());
+				var pixels = render.Pixels();
+				Assert.IsNotNull(pixels);
+				return pixels;
+			}
+		}
+
+		/// <summary>
+		/// Root mean square error of the RGB channels of a against b.
+		/// </summary>
+		static double Rmse(float[] a, float[] b)
+		{
+			Assert.AreEqual(a.Length, b.Length);
+			var sum = 0.0;
+			for (var i = 0; i < a.Length; i += 4)
+			{
+				for (var c = 0; c < 3; c++)
+				{
+					var d = (double)a[i + c] - b[i + c];
+					sum += d * d;
+				}
+			}
+			return Math.Sqrt(sum / (a.Length / 4 * 3));
+		}
+
+		static float[] DenoisedPixels(TestRender render, out double seconds)
+		{
+			var buffer = IntPtr.Zero;
+			seconds = render.Session.GetDenoisedPixelBuffer(ref buffer);
+			if (buffer == IntPtr.Zero) return null;
+			var pixels = new float[render.Width * render.Height * 4];
+			Marshal.Copy(buffer, pixels, 0, pixels.Length);
+			return pixels;
+		}
+
+		/// <summary>
+		/// A noisy render with the normal and diffuse color guide passes.
+		/// </summary>
+		static TestRender NoisyRender(uint iterations)
+		{
+			var render = new TestRender("scene_cube.xml", NoisySamples, 0, Width, Height);
+			render.Session.AddPass(PassType.Normal);
+			render.Session.AddPass(PassType.DiffuseColor);
+			render.Session.SetDenoising(iterations);
+			Assert.AreEqual(0, render.Session.Reset(render.Width, render.Height, render.Samples, 0, 0, render.Width, render.Height));
+			Assert.AreEqual((int)NoisySamples, render.SampleAll());
+			return render;
+		}
+
+		[Test]
+		public void DenoisedIsCloserToReference()
+		{
+			var reference = Reference();
+			using (var render = NoisyRender(4))
+			{
+				var noisy = render.Pixels();
+				Assert.IsNotNull(noisy);
+				var denoised = DenoisedPixels(render, out var seconds);
+				Assert.IsNotNull(denoised);
+				Assert.GreaterOrEqual(seconds, 0.0);
+
+				var noisyError = Rmse(noisy, reference);
+				var denoisedError = Rmse(denoised, reference);
+				TestContext.Out.WriteLine("{0} spp RMSE {1:F5}, denoised {2:F5}", NoisySamples, noisyError, denoisedError);
+				Assert.Less(denoisedError, noisyError);
+			}
+		}
+
+		[Test, Category("Benchmark")]
+		public void IterationSweep()
+		{
+			var reference = Reference();
+			using (var render = NoisyRender(1))
+			{
+				var noisy = render.Pixels();
+				Assert.IsNotNull(noisy);
+				TestContext.Out.WriteLine("{0}x{1}, {2} spp: RMSE {3:F5}", Width, Height, NoisySamples, Rmse(noisy, reference));
+
+				for (uint iterations = 1; iterations <= 5; iterations++)
+				{
+					render.Session.SetDenoising(iterations);
+					Assert.AreEqual(0, render.Session.Denoise());
+					var denoised = DenoisedPixels(render, out var seconds);
+					Assert.IsNotNull(denoised);
+					TestContext.Out.WriteLine("  {0} iterations: RMSE {1:F5}, {2:F4}s", iterations, Rmse(denoised, reference), seconds);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,108 @@
+﻿using System.Collections.Generic;
+using System.IO;
+using System.Text;
+using NUnit.Framework;
+using ccl;
+
+namespace csycles_unittests
+{
+	/// <summary>
+	/// Write an EXR of a region render and read its header back.
+	/// </summary>
+	[TestFixture]
+	public class TestExr
+	{
+		const uint Width = 96;
+		const uint Height = 64;
+		const uint Samples = 2;
+
+		/// <summary>
+		/// Channel names, display window and data window from the header of an
+		/// EXR file. Windows are min x, min y, max x, max y.
+		/// </summary>
+		class ExrHeader
+		{
+			public List<string> Channels { get; } = new List<string>();
+			public int[] DisplayWindow { get; private set; }
+			public int[] DataWindow { get; private set; }
+
+			static string ReadName(BinaryReader reader)
+			{
+				var name = new StringBuilder();
+				for (var c = reader.ReadByte(); c != 0; c = reader.ReadByte())
+				{
+					name.Append((char)c);
+				}
+				return name.ToString();
+			}
+
+			static int[] ReadBox(BinaryReader reader)
+			{
+				return new[] { reader.ReadInt32(), reader.ReadInt32(), reader.ReadInt32(), reader.ReadInt32() };
+			}
+
+			public static ExrHeader Read(string path)
+			{
+				var header = new ExrHeader();
+				using (var reader = new BinaryReader(File.OpenRead(path)))
+				{
+					Assert.AreEqual(20000630, reader.ReadInt32());
+					reader.ReadInt32();
+					/* Attributes are name, type, size and value, up to an empty name. */
+					for (var name = ReadName(reader); name.Length > 0; name = ReadName(reader))
+					{
+						ReadName(reader);
+						var size = reader.ReadInt32();
+						switch (name)
+						{
+							case "channels":
+								/* Channel name followed by 16 bytes of channel info, up to an empty name. */
+								for (var channel = ReadName(reader); channel.Length > 0; channel = ReadName(reader))
+								{
+									header.Channels.Add(channel);
+									reader.ReadBytes(16);
+								}
+								break;
+							case "displayWindow":
+								header.DisplayWindow = ReadBox(reader);
+								break;
+							case "dataWindow":
+								header.DataWindow = ReadBox(reader);
+								break;
+							default:
+								reader.ReadBytes(size);
+								break;
+						}
+					}
+				}
+				return header;
+			}
+		}
+
+		[Test]
+		public void RegionRenderRoundTrip()
+		{
+			var path = Path.Combine(Path.GetTempPath(), "csycles_test_region.exr");
+			if (File.Exists(path)) File.Delete(path);
+
+			using (var render = new TestRender("scene_cube.xml", Samples, 0, Width, Height))
+			{
+				render.Session.AddPass(PassType.Depth);
+				render.Session.AddPass(PassType.Normal);
+				Assert.AreEqual(0, render.Session.Reset(render.Width, render.Height, render.Samples, 0, 0, render.Width, render.Height));
+				Assert.AreEqual(0, render.Session.ResetRegion(16, 8, 48, 32, Samples));
+				Assert.AreEqual((int)Samples, render.SampleAll());
+
+				Assert.AreEqual(0, render.Session.WriteExr(path, 16));
+				Assert.AreEqual(0, render.Session.WaitExr());
+			}
+
+			var header = ExrHeader.Read(path);
+			CollectionAssert.AreEquivalent(new[] { "R", "G", "B", "A", "Depth.Z", "Normal.X", "Normal.Y", "Normal.Z" }, header.Channels);
+			CollectionAssert.AreEqual(new[] { 0, 0, (int)Width - 1, (int)Height - 1 }, header.DisplayWindow);
+			CollectionAssert.AreEqual(new[] { 16, 8, 16 + 48 - 1, 8 + 32 - 1 }, header.DataWindow);
+
+			File.Delete(path);
+		}
+	}
+}
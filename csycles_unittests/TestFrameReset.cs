@@ -0,0 +1,147 @@
+﻿using System;
+using NUnit.Framework;
+using ccl;
+using ccl.ShaderNodes;
+
+namespace csycles_unittests
+{
+	[TestFixture]
+	public class TestFrameReset
+	{
+		const uint Size = 64;
+		const uint Samples = 4;
+
+		static readonly Transform QuadStart = Transform.Translate(0.0f, -1.5f, -1.0f);
+		static readonly Transform QuadMoved = Transform.Translate(1.5f, -1.5f, -1.0f);
+
+		/// <summary>
+		/// Add a unit quad mesh with an emission shader, the way the xml reader
+		/// adds meshes.
+		/// </summary>
+		internal static Mesh AddEmissiveQuadMesh(TestRender render)
+		{
+			var shader = new Shader(render.Client, Shader.ShaderType.Material) { Name = "quad emission", UseMis = true };
+			var emission = new EmissionNode();
+			emission.ins.Strength.Value = 20.0f;
+			shader.AddNode(emission);
+			emission.outs.Emission.Connect(shader.Output.ins.Surface);
+			shader.FinalizeGraph();
+			render.Scene.AddShader(shader);
+
+			var verts = new[] { -0.5f, -0.5f, 0.0f, 0.5f, -0.5f, 0.0f, 0.5f, 0.5f, 0.0f, -0.5f, 0.5f, 0.0f };
+			var mesh = new Mesh(render.Client, shader);
+			mesh.Resize((uint)verts.Length, 2);
+			mesh.Reserve((uint)verts.Length, 2);
+			mesh.SetVerts(ref verts);
+			mesh.SetTri(0, 0, 1, 2, shader, false);
+			mesh.SetTri(3, 0, 2, 3, shader, false);
+			return mesh;
+		}
+
+		/// <summary>
+		/// Add an object with an emissive quad mesh. The object itself has no
+		/// shader, so only the mesh shaders tell that it emits light.
+		/// </summary>
+		/// <returns>Object id of the quad</returns>
+		internal static uint AddEmissiveQuad(TestRender render, Transform transform)
+		{
+			var mesh = AddEmissiveQuadMesh(render);
+			var ob = new ccl.Object(render.Client) { Transform = transform };
+			ob.Mesh = mesh;
+			return ob.Id;
+		}
+
+		internal static double MeanDifference(float[] a, float[] b)
+		{
+			Assert.IsNotNull(a);
+			Assert.IsNotNull(b);
+			Assert.AreEqual(a.Length, b.Length);
+			var sum = 0.0;
+			for (var i = 0; i < a.Length; i++)
+			{
+				sum += Math.Abs(a[i] - b[i]);
+			}
+			return sum / a.Length;
+		}
+
+		internal static void FullReset(TestRender render)
+		{
+			Assert.AreEqual(0, render.Session.Reset(render.Width, render.Height, render.Samples, 0, 0, render.Width, render.Height));
+		}
+
+		/// <summary>
+		/// Render the quad in its moved position from scratch.
+		/// </summary>
+		static float[] RenderMovedFromScratch(BvhType bvhType)
+		{
+			using (var render = new TestRender("scene_cube.xml", Samples, 0, Size, Size, bvhType))
+			{
+				AddEmissiveQuad(render, QuadMoved);
+				FullReset(render);
+				render.SampleAll();
+				return render.Pixels();
+			}
+		}
+
+		/// <summary>
+		/// Moving an emissive mesh with ApplyFrame and ResetFrame has to give the
+		/// same image as a full sync of the moved scene. Device data kept from the
+		/// previous frame, such as the light distribution, must not go stale. With a
+		/// static BVH the quad mesh gets baked into world space and has to be
+		/// re-baked at its new position.
+		/// </summary>
+		[TestCase(BvhType.Dynamic)]
+		[TestCase(BvhType.Static)]
+		public void MovedEmissiveMeshMatchesFullSync(BvhType bvhType)
+		{
+			var expected = RenderMovedFromScratch(bvhType);
+
+			using (var render = new TestRender("scene_cube.xml", Samples, 0, Size, Size, bvhType))
+			{
+				var quad = AddEmissiveQuad(render, QuadStart);
+				FullReset(render);
+				render.SampleAll();
+				var before = render.Pixels();
+
+				Assert.AreEqual(1, render.Scene.ApplyFrame(new[] { quad }, new[] { QuadMoved }, null));
+				Assert.AreEqual(0, render.Session.ResetFrame());
+				render.SampleAll();
+				var after = render.Pixels();
+
+				var moved = MeanDifference(before, expected);
+				var remaining = MeanDifference(after, expected);
+				TestContext.Out.WriteLine("{0} BVH, mean difference to full sync: before move {1:G4}, after frame reset {2:G4}", bvhType, moved, remaining);
+				Assert.Greater(moved, 0.0);
+				Assert.Less(remaining, moved * 0.1);
+
+				/* Moving back must not apply a transform twice. */
+				Assert.AreEqual(1, render.Scene.ApplyFrame(new[] { quad }, new[] { QuadStart }, null));
+				Assert.AreEqual(0, render.Session.ResetFrame());
+				render.SampleAll();
+				Assert.Less(MeanDifference(render.Pixels(), before), moved * 0.1);
+			}
+		}
+
+		/// <summary>
+		/// A frame without changes reuses all device data and renders the same image.
+		/// </summary>
+		[Test]
+		public void UnchangedFrameRendersSameImage()
+		{
+			using (var render = new TestRender("scene_cube.xml", Samples, 0, Size, Size))
+			{
+				var quad = AddEmissiveQuad(render, QuadStart);
+				FullReset(render);
+				render.SampleAll();
+				var before = render.Pixels();
+
+				Assert.AreEqual(0, render.Scene.ApplyFrame(new[] { quad }, new[] { QuadStart }, null));
+				Assert.AreEqual(0, render.Session.ResetFrame());
+				render.SampleAll();
+				var after = render.Pixels();
+
+				Assert.Less(MeanDifference(before, after), 1e-4);
+			}
+		}
+	}
+}
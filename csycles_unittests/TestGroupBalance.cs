@@ -0,0 +1,125 @@
+﻿using System;
+using System.Diagnostics;
+using System.Linq;
+using NUnit.Framework;
+using ccl;
+
+namespace csycles_unittests
+{
+	/// <summary>
+	/// Split-frame balancing with Session.Balance over several sessions on the
+	/// CPU device, each capped to a different number of render threads so they
+	/// render at different speeds.
+	/// </summary>
+	[TestFixture]
+	public class TestGroupBalance
+	{
+		const uint Width = 320;
+		const uint Height = 240;
+		const uint Samples = 8;
+		static readonly uint[] ThreadCaps = { 1, 2, 4 };
+
+		static TestRender[] CreateRenders()
+		{
+			return ThreadCaps.Select(threads => new TestRender("scene_cube.xml", Samples, threads, Width, Height)).ToArray();
+		}
+
+		/// <summary>
+		/// Balance the renders over the full frame, then render each session's
+		/// band.
+		/// </summary>
+		/// <returns>Seconds each session took to render its band</returns>
+		static double[] RenderFrame(TestRender[] renders)
+		{
+			Assert.AreEqual(0, Session.Balance(renders.Select(r => r.Session).ToArray(), Samples));
+
+			var seconds = new double[renders.Length];
+			for (var i = 0; i < renders.Length; i++)
+			{
+				var watch = Stopwatch.StartNew();
+				Assert.AreEqual((int)Samples, renders[i].SampleAll());
+				watch.Stop();
+				seconds[i] = watch.Elapsed.TotalSeconds;
+			}
+			return seconds;
+		}
+
+		static double[] Throughputs(TestRender[] renders)
+		{
+			return renders.Select(r =>
+			{
+				r.Session.GetThroughput(out var rate, out var utilization);
+				return rate;
+			}).ToArray();
+		}
+
+		static void Dispose(TestRender[] renders)
+		{
+			foreach (var render in renders) render.Dispose();
+		}
+
+		[Test]
+		public void FasterSessionMeasuresHigherThroughput()
+		{
+			if (Environment.ProcessorCount < ThreadCaps.Max())
+			{
+				Assert.Ignore("Needs at least " + ThreadCaps.Max() + " cores");
+			}
+
+			var renders = CreateRenders();
+			try
+			{
+				RenderFrame(renders);
+				var rates = Throughputs(renders);
+				foreach (var rate in rates) Assert.Greater(rate, 0.0);
+				Assert.Greater(rates[rates.Length - 1], rates[0]);
+
+				/* Rebalancing on the measurements has to succeed as well. */
+				RenderFrame(renders);
+			}
+			finally
+			{
+				Dispose(renders);
+			}
+		}
+
+		[Test]
+		public void SessionsMustShareFullFrame()
+		{
+			var renders = CreateRenders();
+			var other = new TestRender("scene_cube.xml", Samples, 1, Width / 2, Height);
+			try
+			{
+				var sessions = renders.Select(r => r.Session).Append(other.Session).ToArray();
+				Assert.AreEqual(-2, Session.Balance(sessions, Samples));
+			}
+			finally
+			{
+				other.Dispose();
+				Dispose(renders);
+			}
+		}
+
+		[Test, Category("Benchmark")]
+		public void BandTimesEvenOut()
+		{
+			var renders = CreateRenders();
+			try
+			{
+				/* The first frame has no measurements and splits the rows equally. */
+				for (var frame = 0; frame < 3; frame++)
+				{
+					var seconds = RenderFrame(renders);
+					var rates = Throughputs(renders);
+					TestContext.Out.WriteLine("Frame {0}: {1}, slowest/fastest band {2:F2}", frame,
+						string.Join(", ", ThreadCaps.Select((threads, i) => string.Format("{0} threads {1:F3}s {2:F0} px*spp/s", threads, seconds[i], rates[i]))),
+						seconds.Max() / seconds.Min());
+				}
+			}
+			finally
+			{
+				Dispose(renders);
+			}
+		}
+	}
+}
@@ -0,0 +1,89 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using NUnit.Framework;
+using ccl;
+using ccl.ShaderNodes;
+
+namespace csycles_unittests
+{
+	[TestFixture]
+	public class TestImageReload
+	{
+		const uint ImageSize = 16;
+
+		/// <summary>
+		/// Add a material with an image texture node to the scene of render.
+		/// </summary>
+		static ImageTextureNode AddImageShader(TestRender render, out Shader shader)
+		{
+			shader = new Shader(render.Client, Shader.ShaderType.Material) { Name = "image reload" };
+			var image = new ImageTextureNode();
+			var diffuse = new DiffuseBsdfNode();
+			shader.AddNode(image);
+			shader.AddNode(diffuse);
+			image.outs.Color.Connect(diffuse.ins.Color);
+			diffuse.outs.BSDF.Connect(shader.Output.ins.Surface);
+			shader.FinalizeGraph();
+			render.Scene.AddShader(shader);
+			return image;
+		}
+
+		static float[] Gradient()
+		{
+			var pixels = new float[ImageSize * ImageSize * 4];
+			for (var i = 0; i < pixels.Length; i++)
+			{
+				pixels[i] = (i % 97) / 97.0f;
+			}
+			return pixels;
+		}
+
+		/// <summary>
+		/// Setting the pixels an image already holds must not tag it for reloading,
+		/// even from a different buffer. Changed pixels, and the same pixels under
+		/// another name, still have to be reloaded.
+		/// </summary>
+		[Test]
+		public void IdenticalPixelsSkipReload()
+		{
+			using (var render = new TestRender("scene_cube.xml", 1, 0, 32, 32))
+			{
+				var image = AddImageShader(render, out var shader);
+				var clientId = render.Client.Id;
+				var sceneId = render.Scene.Id;
+
+				var first = Gradient();
+				var copy = Gradient();
+				var changed = Gradient();
+				changed[5] += 0.5f;
+
+				var handles = new[]
+				{
+					GCHandle.Alloc(first, GCHandleType.Pinned),
+					GCHandle.Alloc(copy, GCHandleType.Pinned),
+					GCHandle.Alloc(changed, GCHandleType.Pinned),
+				};
+				try
+				{
+					uint Set(string name, GCHandle pixels)
+					{
+						CSycles.shadernode_set_member_float_img(clientId, sceneId, shader.Id, image.Id, image.Type, "builtin-data",
+							name, pixels.AddrOfPinnedObject(), ImageSize, ImageSize, 1, 4);
+						return CSycles.scene_image_reload_count(clientId, sceneId);
+					}
+
+					var reloads = Set("reload test", handles[0]);
+					Assert.AreEqual(reloads, Set("reload test", handles[0]), "same buffer set again");
+					Assert.AreEqual(reloads, Set("reload test", handles[1]), "identical pixels from another buffer");
+					Assert.AreEqual(reloads + 1, Set("reload test", handles[2]), "changed pixels");
+					Assert.AreEqual(reloads + 2, Set("reload test renamed", handles[2]), "same pixels under a new name");
+					Assert.AreEqual(reloads + 2, Set("reload test renamed", handles[2]), "renamed image set again");
+				}
+				finally
+				{
+					foreach (var handle in handles) handle.Free();
+				}
+			}
+		}
+	}
+}
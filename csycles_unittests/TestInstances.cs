@@ -0,0 +1,75 @@
+﻿using NUnit.Framework;
+using ccl;
+
+namespace csycles_unittests
+{
+	[TestFixture]
+	public class TestInstances
+	{
+		const uint Size = 64;
+		const uint Samples = 4;
+		const int Count = 5;
+
+		static Transform[] RowOfQuads()
+		{
+			var transforms = new Transform[Count];
+			for (var i = 0; i < Count; i++)
+			{
+				transforms[i] = Transform.Translate(-2.0f + i, -1.5f, -1.0f);
+			}
+			return transforms;
+		}
+
+		/// <summary>
+		/// Render the row of quads as separate objects, each with a mesh of its own.
+		/// </summary>
+		static float[] RenderSeparateObjects()
+		{
+			using (var render = new TestRender("scene_cube.xml", Samples, 0, Size, Size))
+			{
+				foreach (var transform in RowOfQuads())
+				{
+					TestFrameReset.AddEmissiveQuad(render, transform);
+				}
+				TestFrameReset.FullReset(render);
+				render.SampleAll();
+				return render.Pixels();
+			}
+		}
+
+		/// <summary>
+		/// One scene_add_object_instances call adds Count objects with consecutive ids,
+		/// and the instances render the same as separate objects with their own mesh.
+		/// </summary>
+		[Test]
+		public void AddInstancesInOneCall()
+		{
+			var expected = RenderSeparateObjects();
+
+			using (var render = new TestRender("scene_cube.xml", Samples, 0, Size, Size))
+			{
+				var mesh = TestFrameReset.AddEmissiveQuadMesh(render);
+				TestFrameReset.FullReset(render);
+				render.SampleAll();
+				var empty = render.Pixels();
+
+				var clientId = render.Client.Id;
+				var sceneId = render.Scene.Id;
+				var before = CSycles.scene_object_count(clientId, sceneId);
+				var first = CSycles.scene_add_object_instances(clientId, sceneId, mesh.Id, RowOfQuads(), null, null, null);
+				Assert.AreEqual(before, first);
+				Assert.AreEqual(before + Count, CSycles.scene_object_count(clientId, sceneId));
+
+				TestFrameReset.FullReset(render);
+				render.SampleAll();
+				var instanced = render.Pixels();
+
+				var added = TestFrameReset.MeanDifference(empty, expected);
+				var remaining = TestFrameReset.MeanDifference(instanced, expected);
+				TestContext.Out.WriteLine("mean difference to separate objects: without instances {0:G4}, instanced {1:G4}", added, remaining);
+				Assert.Greater(added, 0.0);
+				Assert.Less(remaining, added * 0.1);
+			}
+		}
+	}
+}
@@ -0,0 +1,42 @@
+﻿using System.Diagnostics;
+using NUnit.Framework;
+using ccl;
+
+namespace csycles_unittests
+{
+	[TestFixture]
+	public class TestManyLights
+	{
+		const uint Samples = 4;
+
+		/// <summary>
+		/// Seconds to sync and render scene_many_lights.xml with the given light
+		/// sampling threshold.
+		/// </summary>
+		static double TimeRender(float threshold)
+		{
+			using (var render = new TestRender("scene_many_lights.xml", Samples, 0, 320, 240))
+			{
+				render.Scene.Integrator.LightSamplingThreshold = threshold;
+				render.Scene.Integrator.TagForUpdate();
+				Assert.AreEqual(0, render.Session.Reset(render.Width, render.Height, render.Samples, 0, 0, render.Width, render.Height));
+
+				var watch = Stopwatch.StartNew();
+				Assert.AreEqual((int)Samples, render.SampleAll());
+				watch.Stop();
+
+				Assert.IsNotNull(render.Pixels());
+				return watch.Elapsed.TotalSeconds;
+			}
+		}
+
+		[Test, Category("Benchmark")]
+		public void TenThousandLights()
+		{
+			var unthresholded = TimeRender(0.0f);
+			var thresholded = TimeRender(0.05f);
+
+			TestContext.Out.WriteLine("10000 lights, {0} samples: threshold 0 {1:F3}s, threshold 0.05 {2:F3}s", Samples, unthresholded, thresholded);
+		}
+	}
+}
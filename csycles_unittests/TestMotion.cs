@@ -0,0 +1,69 @@
+﻿using NUnit.Framework;
+using ccl;
+
+namespace csycles_unittests
+{
+	[TestFixture]
+	public class TestMotion
+	{
+		const uint Size = 64;
+		const uint Samples = 8;
+
+		static readonly Transform QuadCenter = Transform.Translate(0.0f, -1.5f, -1.0f);
+
+		static readonly Transform[] QuadMotion =
+		{
+			Transform.Translate(-1.0f, -1.5f, -1.0f),
+			QuadCenter,
+			Transform.Translate(1.0f, -1.5f, -1.0f),
+		};
+
+		const SceneUpdateFlags MotionBlurTags = SceneUpdateFlags.Objects | SceneUpdateFlags.Meshes | SceneUpdateFlags.Camera | SceneUpdateFlags.Integrator;
+
+		static void AssertTagged(TestRender render, string what)
+		{
+			var flags = render.Scene.UpdateFlags;
+			TestContext.Out.WriteLine("{0}: {1}", what, flags);
+			Assert.AreEqual(MotionBlurTags, flags & MotionBlurTags, what);
+		}
+
+		/// <summary>
+		/// Toggling motion blur tags objects, meshes, camera and integrator, so a
+		/// frame reset picks it up without a full reset. With motion blur on the
+		/// moving quad gets smeared, switching it off again gives back the still
+		/// image.
+		/// </summary>
+		[Test]
+		public void ToggleMotionBlurWithFrameReset()
+		{
+			using (var render = new TestRender("scene_cube.xml", Samples, 0, Size, Size))
+			{
+				var quad = TestFrameReset.AddEmissiveQuad(render, QuadCenter);
+				Assert.AreEqual(0, CSycles.object_set_motion(render.Client.Id, render.Scene.Id, quad, QuadMotion));
+				Assert.AreEqual(-2, CSycles.object_set_motion(render.Client.Id, render.Scene.Id, quad, new[] { QuadCenter, QuadCenter }));
+				TestFrameReset.FullReset(render);
+				render.SampleAll();
+				var still = render.Pixels();
+				Assert.AreEqual(SceneUpdateFlags.None, render.Scene.UpdateFlags & MotionBlurTags, "synced");
+
+				render.Scene.Integrator.MotionBlur = true;
+				AssertTagged(render, "motion blur on");
+				Assert.AreEqual(0, render.Session.ResetFrame());
+				render.SampleAll();
+				var blurred = render.Pixels();
+
+				render.Scene.Integrator.MotionBlur = false;
+				AssertTagged(render, "motion blur off");
+				Assert.AreEqual(0, render.Session.ResetFrame());
+				render.SampleAll();
+				var restored = render.Pixels();
+
+				var blur = TestFrameReset.MeanDifference(still, blurred);
+				var remaining = TestFrameReset.MeanDifference(still, restored);
+				TestContext.Out.WriteLine("mean difference to still image: blurred {0:G4}, blur off again {1:G4}", blur, remaining);
+				Assert.Greater(blur, 0.0);
+				Assert.Less(remaining, blur * 0.1);
+			}
+		}
+	}
+}
@@ -0,0 +1,91 @@
+﻿using NUnit.Framework;
+using ccl;
+
+namespace csycles_unittests
+{
+	[TestFixture]
+	public class TestObjectProperties
+	{
+		const uint Size = 64;
+		const uint Samples = 4;
+
+		static readonly Transform[] QuadsStart =
+		{
+			Transform.Translate(-1.5f, -1.5f, -1.0f),
+			Transform.Translate(0.0f, -1.5f, -1.0f),
+			Transform.Translate(1.5f, -1.5f, -1.0f),
+		};
+
+		static readonly Transform[] QuadsMoved =
+		{
+			Transform.Translate(-1.5f, 1.5f, -1.0f),
+			Transform.Translate(0.0f, 1.5f, -1.0f),
+			Transform.Translate(1.5f, 1.5f, -1.0f),
+		};
+
+		static readonly PathRay[] Visibility = { PathRay.AllVisibility, 0, PathRay.AllVisibility };
+
+		/// <summary>
+		/// Render the quads at their moved positions with the middle one hidden,
+		/// set up one object at a time.
+		/// </summary>
+		static float[] RenderExpected()
+		{
+			using (var render = new TestRender("scene_cube.xml", Samples, 0, Size, Size))
+			{
+				for (var i = 0; i < QuadsMoved.Length; i++)
+				{
+					var id = TestFrameReset.AddEmissiveQuad(render, QuadsMoved[i]);
+					CSycles.object_set_visibility(render.Client.Id, render.Scene.Id, id, Visibility[i]);
+				}
+				TestFrameReset.FullReset(render);
+				render.SampleAll();
+				return render.Pixels();
+			}
+		}
+
+		/// <summary>
+		/// Hiding one of several quads with a single scene_objects_set_properties call,
+		/// and moving them all in the same frame, has to render the same as setting
+		/// the scene up one object at a time.
+		/// </summary>
+		[Test]
+		public void BatchVisibilityAndTransformRender()
+		{
+			var expected = RenderExpected();
+
+			using (var render = new TestRender("scene_cube.xml", Samples, 0, Size, Size))
+			{
+				var ids = new uint[QuadsStart.Length];
+				for (var i = 0; i < QuadsStart.Length; i++)
+				{
+					ids[i] = TestFrameReset.AddEmissiveQuad(render, QuadsStart[i]);
+				}
+				TestFrameReset.FullReset(render);
+				render.SampleAll();
+				var before = render.Pixels();
+
+				var count = (uint)ids.Length;
+				Assert.AreEqual(ids.Length, CSycles.scene_objects_set_properties(render.Client.Id, render.Scene.Id, count, ids,
+					Visibility, null, null, null, null, null, null));
+				Assert.AreEqual(ids.Length, render.Scene.ApplyFrame(ids, QuadsMoved, null));
+
+				/* An invalid id rejects the whole batch. */
+				var invalid = new[] { ids[0], uint.MaxValue - 1 };
+				var hideAll = new[] { (PathRay)0, (PathRay)0 };
+				Assert.AreEqual(-2, CSycles.scene_objects_set_properties(render.Client.Id, render.Scene.Id, 2, invalid,
+					hideAll, null, null, null, null, null, null));
+
+				TestFrameReset.FullReset(render);
+				render.SampleAll();
+				var after = render.Pixels();
+
+				var changed = TestFrameReset.MeanDifference(before, expected);
+				var remaining = TestFrameReset.MeanDifference(after, expected);
+				TestContext.Out.WriteLine("mean difference to one object at a time: before {0:G4}, after batch {1:G4}", changed, remaining);
+				Assert.Greater(changed, 0.0);
+				Assert.Less(remaining, changed * 0.1);
+			}
+		}
+	}
+}
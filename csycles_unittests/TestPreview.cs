@@ -0,0 +1,81 @@
+﻿using System;
+using NUnit.Framework;
+using ccl;
+
+namespace csycles_unittests
+{
+	[TestFixture]
+	public class TestPreview
+	{
+		const uint Size = 64;
+		const int StartResolution = 8;
+		const int Divider = (int)Size / StartResolution;
+
+		static float Luminance(float[] p, int i)
+		{
+			return 0.2126f * p[i] + 0.7152f * p[i + 1] + 0.0722f * p[i + 2];
+		}
+
+		/// <summary>
+		/// Largest luminance difference between pixels step apart in a row.
+		/// </summary>
+		static float MaxStep(float[] pixels, int width, int height, int step)
+		{
+			var max = 0.0f;
+			for (var y = 0; y < height; y++)
+			{
+				for (var x = 0; x + step < width; x++)
+				{
+					var i = (y * width + x) * 4;
+					var j = (y * width + x + step) * 4;
+					max = Math.Max(max, Math.Abs(Luminance(pixels, i) - Luminance(pixels, j)));
+				}
+			}
+			return max;
+		}
+
+		/// <summary>
+		/// With a coarse start resolution the first samples are pushed as previews
+		/// upsampled to the full render size. Upsampling keeps hard edges: the
+		/// largest step between neighbouring pixels is most of the step between
+		/// pixels one coarse pixel apart. Plain bilinear upsampling would spread it
+		/// evenly, giving 1 / Divider of it.
+		/// </summary>
+		[Test]
+		public void CoarsePreviewIsFullSizeWithHardEdges()
+		{
+			using (var render = new TestRender("scene_cube.xml", 4, 0, Size, Size, BvhType.Dynamic, StartResolution))
+			{
+				float[] preview = null;
+				uint previewWidth = 0, previewHeight = 0;
+				CSycles.RenderTileCallback onTile = (sid, x, y, w, h, sample, depth, passtype, pixels, len) =>
+				{
+					/* Tiles are 32x32, so only previews cover the whole frame. */
+					if (preview != null || w != Size || h != Size) return;
+					preview = (float[])pixels.Clone();
+					previewWidth = w;
+					previewHeight = h;
+				};
+				render.Session.UpdateTileCallback = onTile;
+				CSycles.session_set_progressive_preview(render.Client.Id, render.Session.Id, true);
+
+				render.SampleAll();
+
+				Assert.IsNotNull(preview);
+				Assert.AreEqual(Size, previewWidth);
+				Assert.AreEqual(Size, previewHeight);
+				Assert.AreEqual((int)(Size * Size * 4), preview.Length);
+
+				var coarseStep = MaxStep(preview, (int)Size, (int)Size, Divider);
+				var pixelStep = MaxStep(preview, (int)Size, (int)Size, 1);
+				TestContext.Out.WriteLine("largest step over one pixel {0:G4}, over {1} pixels {2:G4}", pixelStep, Divider, coarseStep);
+				Assert.Greater(coarseStep, 0.1f);
+				Assert.Greater(pixelStep, 0.4f * coarseStep);
+
+				CSycles.session_set_progressive_preview(render.Client.Id, render.Session.Id, false);
+				render.Session.UpdateTileCallback = null;
+				GC.KeepAlive(onTile);
+			}
+		}
+	}
+}
@@ -0,0 +1,114 @@
+﻿using System;
+using System.Drawing;
+using System.IO;
+using System.Runtime.InteropServices;
+using ccl;
+
+namespace csycles_unittests
+{
+	/// <summary>
+	/// A scene from the tests directory loaded into a CPU session of its own,
+	/// for tests that need to actually render through ccycles.
+	/// </summary>
+	public class TestRender : IDisposable
+	{
+		public Client Client { get; }
+		public Session Session { get; }
+		public Scene Scene { get; }
+		public uint Width { get; }
+		public uint Height { get; }
+		public uint Samples { get; }
+
+		/// <summary>
+		/// Load sceneFile and reset the session to render it.
+		/// </summary>
+		/// <param name="sceneFile">Scene file name in the tests directory</param>
+		/// <param name="samples">Samples to render</param>
+		/// <param name="threads">Render threads, 0 for all cores</param>
+		/// <param name="width">Render width, 0 for the width of the scene camera</param>
+		/// <param name="height">Render height, 0 for the height of the scene camera</param>
+		/// <param name="bvhType">BVH type of the scene</param>
+		/// <param name="startResolution">Resolution of the first progressive sample, int.MaxValue to start at full resolution</param>
+		public TestRender(string sceneFile, uint samples, uint threads = 0, uint width = 0, uint height = 0, BvhType bvhType = BvhType.Dynamic, int startResolution = int.MaxValue)
+		{
+			Client = new Client();
+			var sessionParams = new SessionParameters(Client, Device.FirstCpu)
+			{
+				Experimental = false,
+				Samples = (int)samples,
+				TileSize = new Size(32, 32),
+				StartResolution = startResolution,
+				Threads = threads,
+				ShadingSystem = ShadingSystem.SVM,
+				Background = false,
+				ProgressiveRefine = false,
+				Progressive = true,
+				TileOrder = TileOrder.Center
+			};
+			Session = new Session(Client, sessionParams);
+
+			var sceneParams = new SceneParameters(Client, ShadingSystem.SVM, bvhType, false, BvhLayout.Default, false);
+			Scene = new Scene(Client, sceneParams, Session);
+			Session.Scene = Scene;
+
+			var xml = new CSyclesXmlReader(Client, ScenePath(sceneFile));
+			xml.Parse(true);
+
+			Width = width > 0 ? width : (uint)Scene.Camera.Size.Width;
+			Height = height > 0 ? height : (uint)Scene.Camera.Size.Height;
+			Samples = samples;
+			Session.Reset(Width, Height, Samples, 0, 0, Width, Height);
+		}
+
+		/// <summary>
+		/// Full path of a file in the tests directory, found by walking up from
+		/// the test assembly.
+		/// </summary>
+		public static string ScenePath(string sceneFile)
+		{
+			var dir = Path.GetDirectoryName(System.Reflection.Assembly.GetExecutingAssembly().Location);
+			while (!string.IsNullOrEmpty(dir))
+			{
+				var candidate = Path.Combine(dir, "tests", sceneFile);
+				if (File.Exists(candidate)) return candidate;
+				dir = Path.GetDirectoryName(dir);
+			}
+			throw new FileNotFoundException("Test scene not found", sceneFile);
+		}
+
+		/// <summary>
+		/// Sample until the session has rendered all its samples.
+		/// </summary>
+		/// <returns>Number of samples rendered</returns>
+		public int SampleAll()
+		{
+			Session.PrepareRun();
+			var count = 0;
+			while (count < Samples && Session.Sample() >= 0)
+			{
+				count++;
+			}
+			Session.EndRun();
+			return count;
+		}
+
+		/// <summary>
+		/// Copy of the RGBA pixels of pass, null if the pass has not been rendered.
+		/// </summary>
+		public float[] Pixels(PassType pass = PassType.Combined)
+		{
+			var buffer = IntPtr.Zero;
+			Session.GetPixelBuffer(pass, ref buffer);
+			if (buffer == IntPtr.Zero) return null;
+			var pixels = new float[Width * Height * 4];
+			Marshal.Copy(buffer, pixels, 0, pixels.Length);
+			return pixels;
+		}
+
+		public void Dispose()
+		{
+			Session.Destroy();
+			Client.Dispose();
+		}
+	}
+}
@@ -0,0 +1,71 @@
+﻿using System.Linq;
+using NUnit.Framework;
+using ccl;
+
+namespace csycles_unittests
+{
+	[TestFixture]
+	public class TestResetLatency
+	{
+		const int Moves = 20;
+
+		/// <summary>
+		/// Average reset-to-first-sample latency over a number of camera moves,
+		/// resetting with reset.
+		/// </summary>
+		static double MeasureMoves(TestRender render, System.Func<Session, int> reset)
+		{
+			var latencies = new double[Moves];
+			for (var i = 0; i < Moves; i++)
+			{
+				render.Scene.Camera.Matrix = Transform.Translate(0.01f * i, 0.0f, -5.0f);
+				Assert.AreEqual(0, reset(render.Session));
+
+				render.Session.PrepareRun();
+				Assert.GreaterOrEqual(render.Session.Sample(), 0);
+				render.Session.EndRun();
+
+				latencies[i] = render.Session.ResetLatency;
+				Assert.Greater(latencies[i], 0.0);
+			}
+			return latencies.Average();
+		}
+
+		[Test, Category("Benchmark")]
+		public void CameraResetIsNotSlowerThanFullReset()
+		{
+			using (var render = new TestRender("scene_cube.xml", 1, 0, 320, 240))
+			{
+				/* warm up: first render builds BVH and loads kernels. */
+				render.SampleAll();
+
+				var full = MeasureMoves(render, s => s.Reset(render.Width, render.Height, render.Samples, 0, 0, render.Width, render.Height));
+				var camera = MeasureMoves(render, s => s.ResetCamera());
+
+				TestContext.Out.WriteLine("reset-to-first-sample over {0} camera moves: full reset {1:F4}s, camera reset {2:F4}s", Moves, full, camera);
+				/* generous margin, this only has to catch camera resets doing a full scene update. */
+				Assert.LessOrEqual(camera, full * 1.25);
+			}
+		}
+
+		[Test]
+		public void CameraResetRendersMovedCamera()
+		{
+			using (var render = new TestRender("scene_cube.xml", 1, 0, 64, 64))
+			{
+				render.SampleAll();
+				var before = render.Pixels();
+
+				/* look away from the cube, only the background should be left. */
+				render.Scene.Camera.Matrix = Transform.Translate(0.0f, 100.0f, -5.0f);
+				Assert.AreEqual(0, render.Session.ResetCamera());
+				render.SampleAll();
+				var after = render.Pixels();
+
+				Assert.IsNotNull(before);
+				Assert.IsNotNull(after);
+				CollectionAssert.AreNotEqual(before, after);
+			}
+		}
+	}
+}
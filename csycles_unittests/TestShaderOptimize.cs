@@ -0,0 +1,83 @@
+﻿using NUnit.Framework;
+using ccl;
+using ccl.ShaderNodes;
+
+namespace csycles_unittests
+{
+	[TestFixture]
+	public class TestShaderOptimize
+	{
+		/// <summary>
+		/// A constant math chain driving the emission strength and two identical
+		/// noise textures mixed into the diffuse color. Both math nodes fold
+		/// away and one of the noise textures gets merged into the other.
+		/// </summary>
+		[Test]
+		public void ConstantChainAndDuplicateTextureAreRemoved()
+		{
+			using (var render = new TestRender("scene_cube.xml", 1))
+			{
+				var shader = new Shader(render.Client, Shader.ShaderType.Material) { Name = "redundant" };
+
+				var add = new MathNode("add") { Operation = MathNode.Operations.Add };
+				add.ins.Value1.Value = 1.0f;
+				add.ins.Value2.Value = 2.0f;
+				var multiply = new MathNode("multiply") { Operation = MathNode.Operations.Multiply };
+				multiply.ins.Value2.Value = 3.0f;
+				var emission = new EmissionNode();
+
+				var noise1 = new NoiseTexture("noise 1");
+				var noise2 = new NoiseTexture("noise 2");
+				var mix = new MixNode("mix") { BlendType = MixNode.BlendTypes.Add };
+				mix.ins.Fac.Value = 0.5f;
+				var diffuse = new DiffuseBsdfNode();
+				var sum = new AddClosureNode();
+
+				foreach (var node in new ShaderNode[] { add, multiply, emission, noise1, noise2, mix, diffuse, sum })
+				{
+					shader.AddNode(node);
+				}
+
+				add.outs.Value.Connect(multiply.ins.Value1);
+				multiply.outs.Value.Connect(emission.ins.Strength);
+				noise1.outs.Color.Connect(mix.ins.Color1);
+				noise2.outs.Color.Connect(mix.ins.Color2);
+				mix.outs.Color.Connect(diffuse.ins.Color);
+				diffuse.outs.BSDF.Connect(sum.ins.Closure1);
+				emission.outs.Emission.Connect(sum.ins.Closure2);
+				sum.outs.Closure.Connect(shader.Output.ins.Surface);
+
+				shader.FinalizeGraph();
+				render.Scene.AddShader(shader);
+
+				var removed = shader.OptimizeGraph();
+				TestContext.Out.WriteLine("{0} nodes removed", removed);
+				Assert.GreaterOrEqual(removed, 3);
+
+				/* The graph is simplified now, a second call can't remove anything. */
+				Assert.AreEqual(-2, shader.OptimizeGraph());
+			}
+		}
+
+		/// <summary>
+		/// A graph without redundant nodes reports nothing removed, which is
+		/// different from having been simplified already.
+		/// </summary>
+		[Test]
+		public void MinimalGraphRemovesNothing()
+		{
+			using (var render = new TestRender("scene_cube.xml", 1))
+			{
+				var shader = new Shader(render.Client, Shader.ShaderType.Material) { Name = "minimal" };
+				var diffuse = new DiffuseBsdfNode();
+				shader.AddNode(diffuse);
+				diffuse.outs.BSDF.Connect(shader.Output.ins.Surface);
+				shader.FinalizeGraph();
+				render.Scene.AddShader(shader);
+
+				Assert.AreEqual(0, shader.OptimizeGraph());
+				Assert.AreEqual(-2, shader.OptimizeGraph());
+			}
+		}
+	}
+}
@@ -0,0 +1,64 @@
+﻿using System.Linq;
+using System.Threading.Tasks;
+using NUnit.Framework;
+using ccl;
+using ccl.ShaderNodes;
+
+namespace csycles_unittests
+{
+	[TestFixture]
+	public class TestUstringCache
+	{
+		const int Threads = 8;
+		const int ShadersPerThread = 20;
+		/* more unique names per thread than the ustring cache holds, so it starts over. */
+		const int NamesPerThread = 5000;
+
+		/// <summary>
+		/// Build shader graphs on several threads at once, each in a scene of its
+		/// own. Socket lookups and connects all go through the per thread ustring
+		/// cache, including lookups with names no node has and with null names.
+		/// </summary>
+		[Test]
+		public void ShaderGraphsBuildConcurrently()
+		{
+			var renders = Enumerable.Range(0, Threads).Select(_ => new TestRender("scene_cube.xml", 1, 1, 32, 32)).ToArray();
+			try
+			{
+				var tasks = renders.Select((render, t) => Task.Run(() =>
+				{
+					for (var i = 0; i < ShadersPerThread; i++)
+					{
+						var shader = new Shader(render.Client, Shader.ShaderType.Material) { Name = $"thread {t} shader {i}" };
+						var diffuse = new DiffuseBsdfNode();
+						diffuse.ins.Color.Value = new float4(0.8f, 0.2f, 0.1f);
+						shader.AddNode(diffuse);
+						diffuse.outs.BSDF.Connect(shader.Output.ins.Surface);
+						shader.FinalizeGraph();
+
+						CSycles.shadernode_set_attribute_float(render.Client.Id, render.Scene.Id, shader.Id, diffuse.Id, null, 1.0f);
+						for (var n = 0; n < NamesPerThread / ShadersPerThread; n++)
+						{
+							CSycles.shadernode_set_attribute_float(render.Client.Id, render.Scene.Id, shader.Id, diffuse.Id, $"missing {t} {i} {n}", 1.0f);
+						}
+						shader.Tag();
+					}
+				})).ToArray();
+
+				Assert.IsTrue(Task.WaitAll(tasks, 120000));
+
+				foreach (var render in renders)
+				{
+					Assert.AreEqual(1, render.SampleAll());
+				}
+			}
+			finally
+			{
+				foreach (var render in renders)
+				{
+					render.Dispose();
+				}
+			}
+		}
+	}
+}